@@ -0,0 +1,111 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/miniconda/lib/cmake/fmt/fmt-config-version.cmake"
+  "/root/miniconda/lib/cmake/fmt/fmt-config.cmake"
+  "/root/miniconda/lib/cmake/fmt/fmt-targets-release.cmake"
+  "/root/miniconda/lib/cmake/fmt/fmt-targets.cmake"
+  "/root/miniconda/lib/cmake/spdlog/spdlogConfig.cmake"
+  "/root/miniconda/lib/cmake/spdlog/spdlogConfigTargets-release.cmake"
+  "/root/miniconda/lib/cmake/spdlog/spdlogConfigTargets.cmake"
+  "/root/miniconda/lib/cmake/spdlog/spdlogConfigVersion.cmake"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "CMakeFiles/VerifyGlobs.cmake"
+  "CMakeFiles/cmake.verify_globs"
+  "/root/repo/cmake/Findhiredis.cmake"
+  "/root/repo/cmake/scanners.cmake"
+  "/root/repo/examples/CMakeLists.txt"
+  "/root/repo/examples/cli_client/CMakeLists.txt"
+  "/root/repo/examples/echo/CMakeLists.txt"
+  "/root/repo/examples/fairness/CMakeLists.txt"
+  "/root/repo/examples/local_latency/CMakeLists.txt"
+  "/root/repo/examples/loop_lifecycle/CMakeLists.txt"
+  "/root/repo/examples/prefork_echo/CMakeLists.txt"
+  "/root/repo/examples/relay/CMakeLists.txt"
+  "/root/repo/test/CMakeLists.txt"
+  "/usr/lib/x86_64-linux-gnu/cmake/Boost-1.74.0/BoostConfig.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/Boost-1.74.0/BoostConfigVersion.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/BoostDetectToolset-1.74.0.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_headers-1.74.0/boost_headers-config-version.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_headers-1.74.0/boost_headers-config.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_unit_test_framework-1.74.0/boost_unit_test_framework-config-version.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_unit_test_framework-1.74.0/boost_unit_test_framework-config.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_unit_test_framework-1.74.0/libboost_unit_test_framework-variant-shared.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_unit_test_framework-1.74.0/libboost_unit_test_framework-variant-static.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindDependencyMacro.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindBoost.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/cli_client/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/echo/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/fairness/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/local_latency/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/loop_lifecycle/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/prefork_echo/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/relay/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/mini_muduo.dir/DependInfo.cmake"
+  "CMakeFiles/format.dir/DependInfo.cmake"
+  "examples/cli_client/CMakeFiles/cli_client.dir/DependInfo.cmake"
+  "examples/echo/CMakeFiles/echo.dir/DependInfo.cmake"
+  "examples/echo/CMakeFiles/echo_bench.dir/DependInfo.cmake"
+  "examples/fairness/CMakeFiles/fairness.dir/DependInfo.cmake"
+  "examples/local_latency/CMakeFiles/local_latency.dir/DependInfo.cmake"
+  "examples/loop_lifecycle/CMakeFiles/loop_lifecycle.dir/DependInfo.cmake"
+  "examples/prefork_echo/CMakeFiles/prefork_echo.dir/DependInfo.cmake"
+  "examples/relay/CMakeFiles/relay.dir/DependInfo.cmake"
+  "test/CMakeFiles/event_loop_unittest.dir/DependInfo.cmake"
+  "test/CMakeFiles/timer_queue_unittest.dir/DependInfo.cmake"
+  "test/CMakeFiles/buffer_unittest.dir/DependInfo.cmake"
+  "test/CMakeFiles/event_loop_thread_pool_unittest.dir/DependInfo.cmake"
+  "test/CMakeFiles/prefork_server_unittest.dir/DependInfo.cmake"
+  "test/CMakeFiles/tcp_connection_unittest.dir/DependInfo.cmake"
+  "test/CMakeFiles/udp_socket_unittest.dir/DependInfo.cmake"
+  )
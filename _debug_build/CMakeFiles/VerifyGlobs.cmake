@@ -0,0 +1,139 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by CMake Version 3.25
+cmake_policy(SET CMP0009 NEW)
+
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/examples/*.cpp")
+set(OLD_GLOB
+  "/root/repo/examples/cli_client/main.cpp"
+  "/root/repo/examples/echo/bench.cpp"
+  "/root/repo/examples/echo/echo.cpp"
+  "/root/repo/examples/echo/main.cpp"
+  "/root/repo/examples/fairness/main.cpp"
+  "/root/repo/examples/hiredis_demo/hiredis_wrapper.cpp"
+  "/root/repo/examples/hiredis_demo/main.cpp"
+  "/root/repo/examples/hiredis_demo/redis_cache_client.cpp"
+  "/root/repo/examples/local_latency/main.cpp"
+  "/root/repo/examples/loop_lifecycle/main.cpp"
+  "/root/repo/examples/prefork_echo/main.cpp"
+  "/root/repo/examples/relay/main.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/examples/*.h")
+set(OLD_GLOB
+  "/root/repo/examples/echo/echo.h"
+  "/root/repo/examples/hiredis_demo/hiredis_wrapper.h"
+  "/root/repo/examples/hiredis_demo/redis_cache_client.h"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SRC_FILES at CMakeLists.txt:19 (file)
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/include/*.h")
+set(OLD_GLOB
+  "/root/repo/include/mini_muduo/buffer.h"
+  "/root/repo/include/mini_muduo/callbacks.h"
+  "/root/repo/include/mini_muduo/channel.h"
+  "/root/repo/include/mini_muduo/endian.h"
+  "/root/repo/include/mini_muduo/event_loop.h"
+  "/root/repo/include/mini_muduo/event_loop_thread.h"
+  "/root/repo/include/mini_muduo/event_loop_thread_pool.h"
+  "/root/repo/include/mini_muduo/inet_address.h"
+  "/root/repo/include/mini_muduo/latency_histogram.h"
+  "/root/repo/include/mini_muduo/log.h"
+  "/root/repo/include/mini_muduo/prefork_server.h"
+  "/root/repo/include/mini_muduo/socket_ops.h"
+  "/root/repo/include/mini_muduo/tcp_client.h"
+  "/root/repo/include/mini_muduo/tcp_connection.h"
+  "/root/repo/include/mini_muduo/tcp_relay.h"
+  "/root/repo/include/mini_muduo/tcp_server.h"
+  "/root/repo/include/mini_muduo/timer_id.h"
+  "/root/repo/include/mini_muduo/timestamp.h"
+  "/root/repo/include/mini_muduo/udp_server.h"
+  "/root/repo/include/mini_muduo/udp_socket.h"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SRC_FILES at CMakeLists.txt:19 (file)
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/src/*.cpp")
+set(OLD_GLOB
+  "/root/repo/src/acceptor.cpp"
+  "/root/repo/src/buffer.cpp"
+  "/root/repo/src/channel.cpp"
+  "/root/repo/src/connector.cpp"
+  "/root/repo/src/epoller.cpp"
+  "/root/repo/src/event_loop.cpp"
+  "/root/repo/src/event_loop_thread.cpp"
+  "/root/repo/src/event_loop_thread_pool.cpp"
+  "/root/repo/src/inet_address.cpp"
+  "/root/repo/src/log.cpp"
+  "/root/repo/src/output_queue.cpp"
+  "/root/repo/src/prefork_server.cpp"
+  "/root/repo/src/socket.cpp"
+  "/root/repo/src/socket_ops.cpp"
+  "/root/repo/src/tcp_client.cpp"
+  "/root/repo/src/tcp_connection.cpp"
+  "/root/repo/src/tcp_relay.cpp"
+  "/root/repo/src/tcp_server.cpp"
+  "/root/repo/src/timer_queue.cpp"
+  "/root/repo/src/udp_server.cpp"
+  "/root/repo/src/udp_socket.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SRC_FILES at CMakeLists.txt:19 (file)
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/src/*.h")
+set(OLD_GLOB
+  "/root/repo/src/acceptor.h"
+  "/root/repo/src/connector.h"
+  "/root/repo/src/epoller.h"
+  "/root/repo/src/output_queue.h"
+  "/root/repo/src/socket.h"
+  "/root/repo/src/timer.h"
+  "/root/repo/src/timer_queue.h"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/*.cpp")
+set(OLD_GLOB
+  "/root/repo/test/buffer_unittest.cpp"
+  "/root/repo/test/event_loop_thread_pool_unittest.cpp"
+  "/root/repo/test/event_loop_unittest.cpp"
+  "/root/repo/test/prefork_server_unittest.cpp"
+  "/root/repo/test/tcp_connection_unittest.cpp"
+  "/root/repo/test/timer_queue_unittest.cpp"
+  "/root/repo/test/udp_socket_unittest.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# ALL_SRC_FILES at cmake/scanners.cmake:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/*.h")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_debug_build/CMakeFiles/cmake.verify_globs")
+endif()
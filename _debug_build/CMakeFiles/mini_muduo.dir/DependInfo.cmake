@@ -0,0 +1,39 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/acceptor.cpp" "CMakeFiles/mini_muduo.dir/src/acceptor.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/acceptor.cpp.o.d"
+  "/root/repo/src/buffer.cpp" "CMakeFiles/mini_muduo.dir/src/buffer.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/buffer.cpp.o.d"
+  "/root/repo/src/channel.cpp" "CMakeFiles/mini_muduo.dir/src/channel.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/channel.cpp.o.d"
+  "/root/repo/src/connector.cpp" "CMakeFiles/mini_muduo.dir/src/connector.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/connector.cpp.o.d"
+  "/root/repo/src/epoller.cpp" "CMakeFiles/mini_muduo.dir/src/epoller.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/epoller.cpp.o.d"
+  "/root/repo/src/event_loop.cpp" "CMakeFiles/mini_muduo.dir/src/event_loop.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/event_loop.cpp.o.d"
+  "/root/repo/src/event_loop_thread.cpp" "CMakeFiles/mini_muduo.dir/src/event_loop_thread.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/event_loop_thread.cpp.o.d"
+  "/root/repo/src/event_loop_thread_pool.cpp" "CMakeFiles/mini_muduo.dir/src/event_loop_thread_pool.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/event_loop_thread_pool.cpp.o.d"
+  "/root/repo/src/inet_address.cpp" "CMakeFiles/mini_muduo.dir/src/inet_address.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/inet_address.cpp.o.d"
+  "/root/repo/src/log.cpp" "CMakeFiles/mini_muduo.dir/src/log.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/log.cpp.o.d"
+  "/root/repo/src/output_queue.cpp" "CMakeFiles/mini_muduo.dir/src/output_queue.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/output_queue.cpp.o.d"
+  "/root/repo/src/prefork_server.cpp" "CMakeFiles/mini_muduo.dir/src/prefork_server.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/prefork_server.cpp.o.d"
+  "/root/repo/src/socket.cpp" "CMakeFiles/mini_muduo.dir/src/socket.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/socket.cpp.o.d"
+  "/root/repo/src/socket_ops.cpp" "CMakeFiles/mini_muduo.dir/src/socket_ops.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/socket_ops.cpp.o.d"
+  "/root/repo/src/tcp_client.cpp" "CMakeFiles/mini_muduo.dir/src/tcp_client.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/tcp_client.cpp.o.d"
+  "/root/repo/src/tcp_connection.cpp" "CMakeFiles/mini_muduo.dir/src/tcp_connection.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/tcp_connection.cpp.o.d"
+  "/root/repo/src/tcp_relay.cpp" "CMakeFiles/mini_muduo.dir/src/tcp_relay.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/tcp_relay.cpp.o.d"
+  "/root/repo/src/tcp_server.cpp" "CMakeFiles/mini_muduo.dir/src/tcp_server.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/tcp_server.cpp.o.d"
+  "/root/repo/src/timer_queue.cpp" "CMakeFiles/mini_muduo.dir/src/timer_queue.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/timer_queue.cpp.o.d"
+  "/root/repo/src/udp_server.cpp" "CMakeFiles/mini_muduo.dir/src/udp_server.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/udp_server.cpp.o.d"
+  "/root/repo/src/udp_socket.cpp" "CMakeFiles/mini_muduo.dir/src/udp_socket.cpp.o" "gcc" "CMakeFiles/mini_muduo.dir/src/udp_socket.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,51 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mini_muduo.dir/src/acceptor.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/acceptor.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/buffer.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/buffer.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/channel.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/channel.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/connector.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/connector.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/epoller.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/epoller.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/event_loop.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/event_loop.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/event_loop_thread.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/event_loop_thread.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/event_loop_thread_pool.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/event_loop_thread_pool.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/inet_address.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/inet_address.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/log.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/log.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/output_queue.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/output_queue.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/prefork_server.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/prefork_server.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/socket.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/socket.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/socket_ops.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/socket_ops.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/tcp_client.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/tcp_client.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/tcp_connection.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/tcp_connection.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/tcp_relay.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/tcp_relay.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/tcp_server.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/tcp_server.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/timer_queue.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/timer_queue.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/udp_server.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/udp_server.cpp.o.d"
+  "CMakeFiles/mini_muduo.dir/src/udp_socket.cpp.o"
+  "CMakeFiles/mini_muduo.dir/src/udp_socket.cpp.o.d"
+  "libmini_muduo.pdb"
+  "libmini_muduo.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mini_muduo.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/examples
+# Build directory: /root/repo/_debug_build/examples
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("cli_client")
+subdirs("echo")
+subdirs("fairness")
+subdirs("local_latency")
+subdirs("loop_lifecycle")
+subdirs("prefork_echo")
+subdirs("relay")
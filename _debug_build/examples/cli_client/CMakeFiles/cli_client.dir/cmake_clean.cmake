@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cli_client.dir/main.cpp.o"
+  "CMakeFiles/cli_client.dir/main.cpp.o.d"
+  "cli_client"
+  "cli_client.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cli_client.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
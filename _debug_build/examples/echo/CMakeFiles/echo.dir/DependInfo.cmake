@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/examples/echo/echo.cpp" "examples/echo/CMakeFiles/echo.dir/echo.cpp.o" "gcc" "examples/echo/CMakeFiles/echo.dir/echo.cpp.o.d"
+  "/root/repo/examples/echo/main.cpp" "examples/echo/CMakeFiles/echo.dir/main.cpp.o" "gcc" "examples/echo/CMakeFiles/echo.dir/main.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_debug_build/CMakeFiles/mini_muduo.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
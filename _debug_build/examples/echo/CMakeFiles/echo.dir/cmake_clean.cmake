@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/echo.dir/echo.cpp.o"
+  "CMakeFiles/echo.dir/echo.cpp.o.d"
+  "CMakeFiles/echo.dir/main.cpp.o"
+  "CMakeFiles/echo.dir/main.cpp.o.d"
+  "echo"
+  "echo.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/echo.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
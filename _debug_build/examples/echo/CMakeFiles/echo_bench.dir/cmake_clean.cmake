@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/echo_bench.dir/bench.cpp.o"
+  "CMakeFiles/echo_bench.dir/bench.cpp.o.d"
+  "echo_bench"
+  "echo_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/echo_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/local_latency.dir/main.cpp.o"
+  "CMakeFiles/local_latency.dir/main.cpp.o.d"
+  "local_latency"
+  "local_latency.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/local_latency.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/loop_lifecycle.dir/main.cpp.o"
+  "CMakeFiles/loop_lifecycle.dir/main.cpp.o.d"
+  "loop_lifecycle"
+  "loop_lifecycle.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loop_lifecycle.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
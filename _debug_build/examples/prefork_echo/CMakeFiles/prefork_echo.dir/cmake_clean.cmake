@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/prefork_echo.dir/main.cpp.o"
+  "CMakeFiles/prefork_echo.dir/main.cpp.o.d"
+  "prefork_echo"
+  "prefork_echo.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/prefork_echo.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/relay.dir/main.cpp.o"
+  "CMakeFiles/relay.dir/main.cpp.o.d"
+  "relay"
+  "relay.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/relay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/buffer_unittest.dir/buffer_unittest.cpp.o"
+  "CMakeFiles/buffer_unittest.dir/buffer_unittest.cpp.o.d"
+  "buffer_unittest"
+  "buffer_unittest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/buffer_unittest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
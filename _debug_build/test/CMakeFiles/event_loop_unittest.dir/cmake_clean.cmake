@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/event_loop_unittest.dir/event_loop_unittest.cpp.o"
+  "CMakeFiles/event_loop_unittest.dir/event_loop_unittest.cpp.o.d"
+  "event_loop_unittest"
+  "event_loop_unittest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/event_loop_unittest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
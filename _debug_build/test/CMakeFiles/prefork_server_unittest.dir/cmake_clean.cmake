@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/prefork_server_unittest.dir/prefork_server_unittest.cpp.o"
+  "CMakeFiles/prefork_server_unittest.dir/prefork_server_unittest.cpp.o.d"
+  "prefork_server_unittest"
+  "prefork_server_unittest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/prefork_server_unittest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
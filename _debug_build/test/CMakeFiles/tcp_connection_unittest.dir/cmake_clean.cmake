@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tcp_connection_unittest.dir/tcp_connection_unittest.cpp.o"
+  "CMakeFiles/tcp_connection_unittest.dir/tcp_connection_unittest.cpp.o.d"
+  "tcp_connection_unittest"
+  "tcp_connection_unittest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tcp_connection_unittest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/timer_queue_unittest.dir/timer_queue_unittest.cpp.o"
+  "CMakeFiles/timer_queue_unittest.dir/timer_queue_unittest.cpp.o.d"
+  "timer_queue_unittest"
+  "timer_queue_unittest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/timer_queue_unittest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
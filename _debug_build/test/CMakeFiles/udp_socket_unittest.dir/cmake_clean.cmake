@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_socket_unittest.dir/udp_socket_unittest.cpp.o"
+  "CMakeFiles/udp_socket_unittest.dir/udp_socket_unittest.cpp.o.d"
+  "udp_socket_unittest"
+  "udp_socket_unittest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/udp_socket_unittest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
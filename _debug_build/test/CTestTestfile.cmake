@@ -0,0 +1,20 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test
+# Build directory: /root/repo/_debug_build/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(event_loop_unittest "/root/repo/_debug_build/test/event_loop_unittest")
+set_tests_properties(event_loop_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;3;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(timer_queue_unittest "/root/repo/_debug_build/test/timer_queue_unittest")
+set_tests_properties(timer_queue_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;7;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(buffer_unittest "/root/repo/_debug_build/test/buffer_unittest")
+set_tests_properties(buffer_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;13;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(event_loop_thread_pool_unittest "/root/repo/_debug_build/test/event_loop_thread_pool_unittest")
+set_tests_properties(event_loop_thread_pool_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;17;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(prefork_server_unittest "/root/repo/_debug_build/test/prefork_server_unittest")
+set_tests_properties(prefork_server_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;21;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(tcp_connection_unittest "/root/repo/_debug_build/test/tcp_connection_unittest")
+set_tests_properties(tcp_connection_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;25;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(udp_socket_unittest "/root/repo/_debug_build/test/udp_socket_unittest")
+set_tests_properties(udp_socket_unittest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;29;add_test;/root/repo/test/CMakeLists.txt;0;")
@@ -0,0 +1,98 @@
+// Ping-pong throughput of small messages over loopback.
+//
+// The server echoes in its IO threads, the clients run in the main loop,
+// each keeping one message in flight.
+//
+// Usage: echo_bench [connections] [server_threads] [seconds] [message_bytes]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/log.h>
+#include <mini_muduo/tcp_client.h>
+#include <mini_muduo/tcp_server.h>
+
+using namespace mini_muduo;
+
+static const uint16_t kPort = 2037;
+
+int main(int argc, char *argv[]) {
+    const int connections = argc > 1 ? std::atoi(argv[1]) : 64;
+    const int serverThreads = argc > 2 ? std::atoi(argv[2]) : 1;
+    const int seconds = argc > 3 ? std::atoi(argv[3]) : 5;
+    const size_t messageBytes = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 64;
+
+    setLogLevel(spdlog::level::warn);
+
+    EventLoop loop;
+
+    TcpServer server(&loop, InetAddress(kPort, true), "EchoBenchServer", serverThreads);
+    server.setMessageCallback([](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        conn->send(buf);
+    });
+    server.start();
+
+    const std::string message(messageBytes, 'e');
+    uint64_t received = 0;
+    bool measuring = false;
+
+    std::vector<std::unique_ptr<TcpClient>> clients;
+
+    for (int i = 0; i < connections; i++) {
+        auto client = std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort), "EchoBenchClient");
+
+        client->setConnectionCallback([&message](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->setTcpNoDelay(true);
+                conn->send(message);
+            }
+        });
+
+        client->setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+            // One message in flight, a full one is back
+            if (buf.readableBytes() < message.size()) {
+                return;
+            }
+
+            buf.retrieve(message.size());
+
+            if (measuring) {
+                received++;
+            }
+
+            conn->send(message);
+        });
+
+        client->connect();
+        clients.push_back(std::move(client));
+    }
+
+    // Warm up for a second
+    loop.runAfter(std::chrono::seconds(1), [&] {
+        measuring = true;
+    });
+
+    loop.runAfter(std::chrono::seconds(1 + seconds), [&] {
+        std::printf("%d connections, %d server threads, %zu bytes: %.0f messages/s\n",
+                    connections,
+                    serverThreads,
+                    messageBytes,
+                    static_cast<double>(received) / seconds);
+
+        loop.quit();
+    });
+
+    loop.loop();
+
+    for (auto &client : clients) {
+        client->disconnect();
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Shows how a read budget keeps one firehose connection from delaying
+// everyone else on the loop.
+//
+// One server loop serves a client that streams as fast as it can and
+// a few ping-pong clients. Reports the dispatch latency of the server loop
+// and the round trip time seen by the ping-pong clients.
+//
+// Usage: fairness [read_budget_bytes] [seconds]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/event_loop_thread.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/latency_histogram.h>
+#include <mini_muduo/tcp_client.h>
+#include <mini_muduo/tcp_server.h>
+
+using namespace mini_muduo;
+
+static const uint16_t kPort = 2033;
+static const int kPingClients = 8;
+
+static void printHistogram(const char *what, const LatencyHistogram &histogram) {
+    std::printf("%-20s count %-10llu p50 %6lld us  p99 %6lld us  p99.9 %6lld us\n",
+                what,
+                static_cast<unsigned long long>(histogram.count()),
+                static_cast<long long>(histogram.percentile(0.5).count()),
+                static_cast<long long>(histogram.percentile(0.99).count()),
+                static_cast<long long>(histogram.percentile(0.999).count()));
+}
+
+int main(int argc, char *argv[]) {
+    const size_t readBudget = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 0;
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    EventLoop loop;
+    loop.setDispatchLatencyTracking(true);
+
+    TcpServer server(&loop, InetAddress(kPort, true), "FairnessServer");
+    server.setReadBudget(readBudget);
+
+    // Pretend to parse everything, cost grows with the bytes handed over
+    uint64_t checksum = 0;
+
+    server.setMessageCallback([&checksum](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        const std::string_view data = buf.toStringView();
+
+        for (const char c : data) {
+            checksum = checksum * 31 + static_cast<unsigned char>(c);
+        }
+
+        // Only ping-pong clients send newlines
+        if (!data.empty() && data.back() == '\n') {
+            conn->send(data);
+        }
+
+        buf.retrieveAll();
+    });
+
+    server.start();
+
+    EventLoopThread clientThread("fairness_client");
+    EventLoop *pClientLoop = clientThread.startLoop();
+
+    const InetAddress serverAddr("127.0.0.1", kPort);
+
+    LatencyHistogram roundTrip;
+
+    TcpClient firehose(pClientLoop, serverAddr, "Firehose");
+    const auto chunk = std::make_shared<const std::string>(1024 * 1024, 'x');
+
+    firehose.setConnectionCallback([chunk](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send(chunk, *chunk);
+        }
+    });
+
+    firehose.setWriteCompleteCallback([chunk](const TcpConnectionPtr &conn) {
+        conn->send(chunk, *chunk);
+    });
+
+    firehose.setMessageCallback(defaultMessageCallback);
+
+    std::vector<std::unique_ptr<TcpClient>> pingClients;
+
+    for (int i = 0; i < kPingClients; i++) {
+        auto client = std::make_unique<TcpClient>(pClientLoop, serverAddr, "Ping" + std::to_string(i));
+
+        // The payload carries the send time
+        const auto ping = [](const TcpConnectionPtr &conn) {
+            conn->send(std::to_string(Timestamp::now().timePoint().time_since_epoch().count()) + "\n");
+        };
+
+        client->setConnectionCallback([ping](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                ping(conn);
+            }
+        });
+
+        client->setMessageCallback([ping, &roundTrip](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+            const char *pEol = buf.findEOL();
+
+            if (!pEol) {
+                return;
+            }
+
+            const std::string line(buf.peek(), pEol);
+            buf.retrieveUntil(pEol + 1);
+
+            const Timestamp::TimePoint sent(Timestamp::Clock::duration(std::stoll(line)));
+            roundTrip.record(Timestamp::now().timePoint() - sent);
+
+            ping(conn);
+        });
+
+        pingClients.push_back(std::move(client));
+    }
+
+    firehose.connect();
+
+    for (auto &client : pingClients) {
+        client->connect();
+    }
+
+    loop.runAfter(std::chrono::seconds(seconds), [&loop] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    std::printf("read budget %zu bytes, %d seconds\n", readBudget, seconds);
+    printHistogram("dispatch latency", loop.dispatchLatency());
+    printHistogram("ping round trip", roundTrip);
+
+    pClientLoop->runInLoop([&] {
+        firehose.disconnect();
+
+        for (auto &client : pingClients) {
+            client->disconnect();
+        }
+    });
+
+    (void)checksum;
+
+    return 0;
+}
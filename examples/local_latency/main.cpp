@@ -0,0 +1,111 @@
+// Round trip time of small messages between two loops on one host,
+// over TCP loopback and over a Unix domain socket.
+//
+// The server echoes in its IO thread, one client in the main loop
+// keeps one message in flight, so every round trip crosses both stacks.
+//
+// Usage: local_latency [seconds] [message_bytes]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/latency_histogram.h>
+#include <mini_muduo/log.h>
+#include <mini_muduo/tcp_client.h>
+#include <mini_muduo/tcp_server.h>
+
+using namespace mini_muduo;
+
+static const uint16_t kPort = 2039;
+
+static void measure(const char *what,
+                    const InetAddress &listenAddr,
+                    const InetAddress &serverAddr,
+                    int seconds,
+                    size_t messageBytes) {
+    EventLoop loop;
+
+    TcpServer server(&loop, listenAddr, "LatencyServer", 1);
+    server.setMessageCallback([](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        conn->send(buf);
+    });
+    server.start();
+
+    TcpClient client(&loop, serverAddr, "LatencyClient");
+
+    const std::string message(messageBytes, 'l');
+    LatencyHistogram roundTrip;
+    std::chrono::nanoseconds total{0};
+    uint64_t count = 0;
+    bool measuring = false;
+    Timestamp sent;
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->setTcpNoDelay(true);  // a no-op on the Unix domain socket
+            sent = Timestamp::now();
+            conn->send(message);
+        }
+    });
+
+    client.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        if (buf.readableBytes() < message.size()) {
+            return;
+        }
+
+        buf.retrieve(message.size());
+
+        if (measuring) {
+            const std::chrono::nanoseconds rtt = Timestamp::now().timePoint() - sent.timePoint();
+
+            roundTrip.record(rtt);
+            total += rtt;
+            count++;
+        }
+
+        sent = Timestamp::now();
+        conn->send(message);
+    });
+
+    client.connect();
+
+    // Warm up for a second
+    loop.runAfter(std::chrono::seconds(1), [&] {
+        measuring = true;
+    });
+
+    loop.runAfter(std::chrono::seconds(1 + seconds), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    client.disconnect();
+
+    std::printf("%-10s %zu bytes: %10llu round trips, mean %6.2f us, p50 %4lld us, p99 %4lld us\n",
+                what,
+                messageBytes,
+                static_cast<unsigned long long>(count),
+                count > 0 ? static_cast<double>(total.count()) / static_cast<double>(count) / 1000.0 : 0.0,
+                static_cast<long long>(roundTrip.percentile(0.5).count()),
+                static_cast<long long>(roundTrip.percentile(0.99).count()));
+}
+
+int main(int argc, char *argv[]) {
+    const int seconds = argc > 1 ? std::atoi(argv[1]) : 3;
+    const size_t messageBytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64;
+
+    setLogLevel(spdlog::level::warn);
+
+    measure("loopback", InetAddress(kPort, true), InetAddress("127.0.0.1", kPort), seconds, messageBytes);
+
+    const InetAddress unixAddr = InetAddress::unixDomain("mini_muduo_local_latency", true);
+    measure("unix", unixAddr, unixAddr, seconds, messageBytes);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Time to start and to shut down pools of loop threads.
+//
+// Start covers creating the threads and their loops, shutdown quitting
+// the loops and joining the threads.
+//
+// Usage: loop_lifecycle [rounds] [max_threads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/event_loop_thread_pool.h>
+#include <mini_muduo/log.h>
+
+using namespace mini_muduo;
+
+using Clock = std::chrono::steady_clock;
+
+static double toMs(Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+int main(int argc, char *argv[]) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 5;
+    const int maxThreads = argc > 2 ? std::atoi(argv[2]) : 32;
+
+    setLogLevel(spdlog::level::warn);
+
+    EventLoop loop;
+
+    for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+        Clock::duration startTime{0};
+        Clock::duration shutdownTime{0};
+
+        for (int i = 0; i < rounds; i++) {
+            std::optional<EventLoopThreadPool> pool(std::in_place, &loop, nThreads);
+
+            const auto t0 = Clock::now();
+            pool->start();
+            const auto t1 = Clock::now();
+            pool.reset();
+            const auto t2 = Clock::now();
+
+            startTime += t1 - t0;
+            shutdownTime += t2 - t1;
+        }
+
+        std::printf("%3d threads: start %8.3f ms, shutdown %8.3f ms\n",
+                    nThreads,
+                    toMs(startTime) / rounds,
+                    toMs(shutdownTime) / rounds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Ping-pong throughput of an echo server run as IO threads of one process,
+// and as the same number of single loop worker processes of a PreforkServer.
+//
+// The clients run in the main loop, each keeping one message in flight.
+//
+// Usage: prefork_echo [workers] [connections] [seconds] [message_bytes]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/log.h>
+#include <mini_muduo/prefork_server.h>
+#include <mini_muduo/tcp_client.h>
+#include <mini_muduo/tcp_server.h>
+
+using namespace mini_muduo;
+
+static const uint16_t kPort = 2040;
+
+static void echo(const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+    conn->send(buf);
+}
+
+// Returns round trips per second of @c connections clients against the server on kPort
+static double pingPong(EventLoop &loop, int connections, int seconds, size_t messageBytes) {
+    const std::string message(messageBytes, 'p');
+    uint64_t received = 0;
+    bool measuring = false;
+
+    std::vector<std::unique_ptr<TcpClient>> clients;
+
+    for (int i = 0; i < connections; i++) {
+        auto client = std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort), "PreforkEchoClient");
+
+        client->setConnectionCallback([&message](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->setTcpNoDelay(true);
+                conn->send(message);
+            }
+        });
+
+        client->setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+            // One message in flight, a full one is back
+            if (buf.readableBytes() < message.size()) {
+                return;
+            }
+
+            buf.retrieve(message.size());
+
+            if (measuring) {
+                received++;
+            }
+
+            conn->send(message);
+        });
+
+        client->connect();
+        clients.push_back(std::move(client));
+    }
+
+    // Warm up for a second
+    loop.runAfter(std::chrono::seconds(1), [&] {
+        measuring = true;
+    });
+
+    loop.runAfter(std::chrono::seconds(1 + seconds), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    for (auto &client : clients) {
+        client->disconnect();
+    }
+
+    return static_cast<double>(received) / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    const int workers = argc > 1 ? std::atoi(argv[1]) : 2;
+    const int connections = argc > 2 ? std::atoi(argv[2]) : 64;
+    const int seconds = argc > 3 ? std::atoi(argv[3]) : 5;
+    const size_t messageBytes = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 64;
+
+    setLogLevel(spdlog::level::warn);
+
+    double threads = 0;
+    double processes = 0;
+
+    {
+        EventLoop loop;
+
+        TcpServer server(&loop, InetAddress(kPort, true), "PreforkEchoThreads", workers);
+        server.setMessageCallback(echo);
+        server.start();
+
+        threads = pingPong(loop, connections, seconds, messageBytes);
+    }
+
+    {
+        EventLoop loop;
+
+        // Forked before the clients exist, workers inherit none of them
+        PreforkServer server(&loop, InetAddress(kPort, true), "PreforkEchoProcesses", workers, 0);
+        server.setWorkerInitCallback([](TcpServer &workerServer) {
+            workerServer.setMessageCallback(echo);
+        });
+        server.start();
+
+        processes = pingPong(loop, connections, seconds, messageBytes);
+    }
+
+    std::printf("%d connections, %zu bytes\n", connections, messageBytes);
+    std::printf("%d IO threads:       %10.0f messages/s\n", workers, threads);
+    std::printf("%d worker processes: %10.0f messages/s\n", workers, processes);
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Loopback throughput of a TCP proxy, copying through user space
+// versus TcpRelay with splice(2).
+//
+//   source --> proxy --> sink
+//
+// The source streams as fast as it can, the sink discards everything.
+//
+// Usage: relay [copy|splice] [seconds]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/tcp_client.h>
+#include <mini_muduo/tcp_relay.h>
+#include <mini_muduo/tcp_server.h>
+
+using namespace mini_muduo;
+
+static const uint16_t kSinkPort = 2034;
+static const uint16_t kProxyPort = 2035;
+static const size_t kHighWaterMark = 4 * 1024 * 1024;
+
+class Proxy {
+public:
+    Proxy(EventLoop *pLoop, bool useSplice)
+        : useSplice_(useSplice)
+        , server_(pLoop, InetAddress(kProxyPort, true), "Proxy", 1) {
+        server_.setConnectionCallback([this](const TcpConnectionPtr &conn) {
+            this->onDownstreamConnection(conn);
+        });
+
+        server_.setMessageCallback([this](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+            // Only before the relay takes over, or in copy mode
+            if (auto it = upstreams_.find(conn->name()); it != upstreams_.end() && it->second.conn) {
+                it->second.conn->send(buf);
+            }
+        });
+
+        server_.start();
+    }
+
+private:
+    struct Upstream {
+        std::unique_ptr<TcpClient> client;
+        TcpConnectionPtr conn;
+    };
+
+    void onDownstreamConnection(const TcpConnectionPtr &down) {
+        if (!down->connected()) {
+            upstreams_.erase(down->name());
+            return;
+        }
+
+        // Nowhere to put it yet
+        down->stopRead();
+
+        // Both sides in the same loop, as TcpRelay wants
+        auto client = std::make_unique<TcpClient>(down->getLoop(), InetAddress("127.0.0.1", kSinkPort), down->name());
+        const std::weak_ptr<TcpConnection> weakDown = down;
+
+        client->setConnectionCallback([this, weakDown](const TcpConnectionPtr &up) {
+            const auto down = weakDown.lock();
+
+            if (!down || !up->connected()) {
+                return;
+            }
+
+            upstreams_[down->name()].conn = up;
+
+            if (useSplice_) {
+                if (!TcpRelay::start(down, up)) {
+                    down->forceClose();
+                }
+            } else {
+                // The sink is slower than the source, do not buffer without bound
+                up->setHighWaterMarkCallback(
+                    [weakDown](const TcpConnectionPtr &, size_t) {
+                        if (const auto down = weakDown.lock()) {
+                            down->stopRead();
+                        }
+                    },
+                    kHighWaterMark);
+
+                up->setLowWaterMarkCallback(
+                    [weakDown](const TcpConnectionPtr &, size_t) {
+                        if (const auto down = weakDown.lock()) {
+                            down->startRead();
+                        }
+                    },
+                    kHighWaterMark / 4);
+            }
+
+            down->startRead();
+        });
+
+        client->setMessageCallback([weakDown](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+            if (const auto down = weakDown.lock()) {
+                down->send(buf);
+            }
+        });
+
+        client->connect();
+
+        upstreams_[down->name()].client = std::move(client);
+    }
+
+    const bool useSplice_;
+    TcpServer server_;
+
+    std::map<std::string, Upstream> upstreams_;
+};
+
+int main(int argc, char *argv[]) {
+    const bool useSplice = argc > 1 && std::strcmp(argv[1], "splice") == 0;
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    // Sink and proxy get an IO thread each, the source runs in the main loop
+    EventLoop loop;
+
+    std::atomic<uint64_t> received = 0;
+
+    TcpServer sink(&loop, InetAddress(kSinkPort, true), "Sink", 1);
+    sink.setMessageCallback([&received](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        received.fetch_add(buf.readableBytes(), std::memory_order_relaxed);
+        buf.retrieveAll();
+    });
+    sink.start();
+
+    Proxy proxy(&loop, useSplice);
+
+    const auto chunk = std::make_shared<const std::string>(1024 * 1024, 'x');
+
+    TcpClient source(&loop, InetAddress("127.0.0.1", kProxyPort), "Source");
+    source.setConnectionCallback([chunk](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send(chunk, *chunk);
+        }
+    });
+    source.setWriteCompleteCallback([chunk](const TcpConnectionPtr &conn) {
+        conn->send(chunk, *chunk);
+    });
+    source.setMessageCallback(defaultMessageCallback);
+    source.connect();
+
+    // Skip the first second, connections are still being set up
+    uint64_t startBytes = 0;
+
+    loop.runAfter(std::chrono::seconds(1), [&] {
+        startBytes = received.load(std::memory_order_relaxed);
+    });
+
+    loop.runAfter(std::chrono::seconds(1 + seconds), [&] {
+        const double bytes = static_cast<double>(received.load(std::memory_order_relaxed) - startBytes);
+
+        std::printf("%s: %.1f MiB/s over %d seconds\n",
+                    useSplice ? "splice" : "copy",
+                    bytes / seconds / 1024 / 1024,
+                    seconds);
+
+        loop.quit();
+    });
+
+    loop.loop();
+
+    source.disconnect();
+
+    return 0;
+}
@@ -305,15 +305,25 @@ public:
         swap(other);
     }
 
+    ///
+    /// Drops the storage not needed by the readable bytes.
+    ///
+    /// A drained buffer goes back to the footprint of Buffer(0).
+    void shrinkToFit() {
+        Buffer other(readableBytes());
+        other.append(toStringView());
+        swap(other);
+    }
+
     size_t internalCapacity() const {
         return buffer_.capacity();
     }
 
     /// Read data directly into buffer.
     ///
-    /// It may implement with readv(2)
+    /// It may implement with readv(2), reads no more than @c maxBytes
     /// @return result of read(2), @c errno is saved
-    ssize_t readFd(int fd, int *savedErrno);
+    ssize_t readFd(int fd, int *savedErrno, size_t maxBytes = SIZE_MAX);
 
 private:
     char *begin() {
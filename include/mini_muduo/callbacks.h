@@ -24,6 +24,8 @@ using WriteCompleteCallback = std::function<void(const TcpConnectionPtr &)>;
 
 using HighWaterMarkCallback = std::function<void(const TcpConnectionPtr &, size_t)>;
 
+using LowWaterMarkCallback = std::function<void(const TcpConnectionPtr &, size_t)>;
+
 using CloseCallback = std::function<void(const TcpConnectionPtr &)>;
 
 void defaultConnectionCallback(const TcpConnectionPtr &);
@@ -117,10 +117,32 @@ public:
         return concernedEvents_ == kNoneEvent;
     }
 
+    /// Stays in the poller without events, epoll still reports EPOLLERR and
+    /// EPOLLHUP, which nothing hears of once it is removed.
+    void setKeepRegistered(bool on) {
+        if (keepRegistered_ != on) {
+            keepRegistered_ = on;
+
+            if (addedToLoop_) {
+                update();
+            }
+        }
+    }
+
+    bool keepsRegistered() const {
+        return keepRegistered_;
+    }
+
     EventLoop *ownerLoop() const {
         return pOwnerLoop_;
     }
 
+    /// Hands the channel over to another loop, call it after remove().
+    void setLoop(EventLoop *pLoop) {
+        assert(!addedToLoop_);
+        pOwnerLoop_ = pLoop;
+    }
+
     void remove();
 
 private:
@@ -137,6 +159,7 @@ private:
 
     bool addedToLoop_ = false;
     bool handlingEvents_ = false;
+    bool keepRegistered_ = false;
 
     uint32_t concernedEvents_ = 0;
     uint32_t receivedEvents_ = 0;
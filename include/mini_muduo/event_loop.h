@@ -5,13 +5,17 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
 
 #include <mini_muduo/callbacks.h>
+#include <mini_muduo/latency_histogram.h>
 #include <mini_muduo/timer_id.h>
+#include <mini_muduo/timestamp.h>
 
 namespace mini_muduo {
 
@@ -37,6 +41,49 @@ public:
 
     void queueInLoop(Functor cb);
 
+    /// Runs @c cb once the current iteration has handled its events and
+    /// pending functors, e.g. to flush writes batched during the iteration.
+    /// Not thread safe, but in loop
+    void runAtIterationEnd(Functor cb);
+
+    /// Time when poll returns, usually means data arrival.
+    Timestamp pollReturnTime() const {
+        return pollReturnTime_;
+    }
+
+    /// Records how long each active channel waits between poll return and
+    /// its dispatch, i.e. the time spent on the channels before it.
+    /// Not thread safe, call it before loop().
+    void setDispatchLatencyTracking(bool on) {
+        trackDispatchLatency_ = on;
+    }
+
+    /// Thread safe.
+    const LatencyHistogram &dispatchLatency() const {
+        return dispatchLatency_;
+    }
+
+    /// Total time spent between poll return and the next poll, i.e. on
+    /// events, pending and iteration end functors. A load gauge for
+    /// other threads, sampled twice its difference is the recent load.
+    /// Thread safe.
+    std::chrono::nanoseconds busyTime() const {
+        return std::chrono::nanoseconds(busyTimeNs_.load(std::memory_order_relaxed));
+    }
+
+    /// Duration of the latest iteration, about how long a newly ready
+    /// event waits for the loop to poll again.
+    /// Thread safe.
+    std::chrono::nanoseconds lastIterationTime() const {
+        return std::chrono::nanoseconds(lastIterationNs_.load(std::memory_order_relaxed));
+    }
+
+    /// Functors queued and not run yet.
+    /// Thread safe.
+    size_t pendingFunctorCount() const {
+        return pendingFunctorCount_.load(std::memory_order_relaxed);
+    }
+
     // timers
 
     ///
@@ -67,6 +114,11 @@ public:
 
     void removeChannel(Channel *pChannel);
 
+    /// In a forked child that never runs this loop, closes the epoll, wakeup
+    /// and timer descriptors and those of every channel of the loop.
+    /// Nothing is destroyed, the child must not use the loop afterwards.
+    void closeFdsAfterFork();
+
     void assertInLoopThread() {
         if (!isInLoopThread()) {
             abortNotInLoopThread();
@@ -84,6 +136,8 @@ private:
 
     void callPendingFunctors();
 
+    void callIterationEndFunctors();
+
     const pid_t tid_ = gettid();
 
     bool looping_ = false;
@@ -91,6 +145,19 @@ private:
 
     bool handlingEvents_ = false;
     bool callingPendingFunctors_ = false;
+    bool callingIterationEndFunctors_ = false;
+
+    Timestamp pollReturnTime_;
+
+    bool trackDispatchLatency_ = false;
+    LatencyHistogram dispatchLatency_;
+
+    // Written by the loop thread only
+    std::atomic<int64_t> busyTimeNs_ = 0;
+    std::atomic<int64_t> lastIterationNs_ = 0;
+
+    // Mirrors pendingFunctors_.size() for other threads
+    std::atomic<size_t> pendingFunctorCount_ = 0;
 
     // Pimpl
     const std::unique_ptr<EPoller> poller_;
@@ -99,6 +166,9 @@ private:
 
     std::mutex mu_;
     std::vector<Functor> pendingFunctors_;
+
+    // Loop thread only, no lock
+    std::vector<Functor> iterationEndFunctors_;
 };
 
 }  // namespace mini_muduo
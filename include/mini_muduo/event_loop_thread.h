@@ -8,6 +8,7 @@
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <mini_muduo/event_loop.h>
 
@@ -18,53 +19,55 @@ public:
     EventLoopThread(std::string name = {})
         : name_(std::move(name)) {}
 
-    ~EventLoopThread() {
-        if (pLoop_) {
-            pLoop_->quit();
-
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            thread_.join();
-        }
-    }
+    /// Quits the loop once it ran what is queued to it, and joins the thread.
+    ~EventLoopThread();
 
     EventLoopThread(const EventLoopThread &other) = delete;
     EventLoopThread &operator=(const EventLoopThread &other) = delete;
 
+    /// Pins the loop thread to @c cpus, and with @c bindLocalMemory makes it
+    /// allocate from its local NUMA node, whatever the process policy is.
+    /// The loop is created after, so its memory is local as well.
+    /// Not thread safe, call it before startLoop().
+    void setPlacement(std::vector<int> cpus, bool bindLocalMemory = false) {
+        cpus_ = std::move(cpus);
+        bindLocalMemory_ = bindLocalMemory;
+    }
+
+    /// Starts the thread and waits for its loop.
     EventLoop *startLoop() {
-        thread_ = std::thread([this] {
-            this->threadFunc(this->name_);
-        });
+        start();
+        return waitForLoop();
+    }
 
-        {
-            std::unique_lock lg{mu_};
+    /// Starts the thread without waiting, so that many start at once.
+    /// Not thread safe.
+    void start();
 
-            cond_.wait(lg, [this] {
-                return pLoop_ != nullptr;
-            });
-        }
+    /// Blocks until the loop of start() is created.
+    /// Not thread safe.
+    EventLoop *waitForLoop();
 
-        return pLoop_;
-    }
+    /// Asks the loop to quit, through its queue, so that it is not missed
+    /// before the loop runs. Harmless once the loop is gone.
+    /// Thread safe.
+    void quit();
 
 private:
-    void threadFunc(const std::string &name) {
-        (void)pthread_setname_np(pthread_self(), name.c_str());
+    void threadFunc();
 
-        EventLoop loop;
-
-        {
-            std::lock_guard lg{mu_};
-            pLoop_ = &loop;
-            cond_.notify_one();
-        }
-
-        loop.loop();
-    }
+    void applyPlacement() const;
 
     const std::string name_;
 
-    // Use atomic or lock in dtor???
+    std::vector<int> cpus_;
+    bool bindLocalMemory_ = false;
+
+    // Guarded by mu_, pLoop_ is null again once the loop is gone
     EventLoop *pLoop_ = nullptr;
+    EventLoop *pCreatedLoop_ = nullptr;
+    bool quitRequested_ = false;
+
     std::thread thread_;
 
     std::mutex mu_;
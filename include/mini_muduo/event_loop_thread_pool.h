@@ -1,59 +1,126 @@
 #ifndef MINI_MUDUO_EVENT_LOOP_THREAD_POOL_H
 #define MINI_MUDUO_EVENT_LOOP_THREAD_POOL_H
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
 #include <mini_muduo/event_loop_thread.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/timestamp.h>
 
 namespace mini_muduo {
 
 class EventLoopThreadPool {
 public:
+    enum class SelectionPolicy {
+        ROUND_ROBIN,
+        LEAST_CONNECTIONS,
+        // Least busy time since the last sample, see EventLoop::busyTime()
+        LEAST_BUSY,
+        // Fewer connections of two loops picked at random
+        POWER_OF_TWO_CHOICES,
+        // Same peer IP, same loop, round robin for Unix domain peers
+        PEER_ADDRESS_HASH,
+    };
+
     EventLoopThreadPool(EventLoop *pMainLoop, int nThreads)
         : pMainLoop_(pMainLoop)
-        , nThreads_(nThreads) {}
+        , nThreads_(nThreads)
+        , connections_(std::make_unique<std::atomic<size_t>[]>(nThreads > 0 ? static_cast<size_t>(nThreads) : 1)) {}
 
-    ~EventLoopThreadPool() = default;
+    ~EventLoopThreadPool();
 
     EventLoopThreadPool(const EventLoopThreadPool &other) = delete;
     EventLoopThreadPool &operator=(const EventLoopThreadPool &other) = delete;
 
-    void start() {
-        pMainLoop_->assertInLoopThread();
-
-        for (int i = 0; i < nThreads_; i++) {
-            const std::string threadName = std::string("EventLoopThread#") + std::to_string(i);
+    void start();
 
-            threads_.push_back(std::make_unique<EventLoopThread>(threadName));
+    /// Not thread safe, call it before start().
+    void setSelectionPolicy(SelectionPolicy policy) {
+        policy_ = policy;
+    }
 
-            loops_.push_back(threads_[static_cast<size_t>(i)]->startLoop());
-        }
+    /// Pins thread i to @c cpusPerThread[i % size], see EventLoopThread::setPlacement().
+    /// Not thread safe, call it before start().
+    void setThreadPlacement(std::vector<std::vector<int>> cpusPerThread, bool bindLocalMemory = false) {
+        cpusPerThread_ = std::move(cpusPerThread);
+        bindLocalMemory_ = bindLocalMemory;
     }
 
-    EventLoop *getNextLoop() {
-        if (nThreads_ == 0) {
-            return pMainLoop_;
-        }
+    /// CPUs the thread of @c pLoop is pinned to, empty if it is not.
+    /// Thread safe after start().
+    const std::vector<int> &cpusOf(EventLoop *pLoop) const;
+
+    /// Round robin, whatever the policy.
+    /// Not thread safe, but in main loop
+    EventLoop *getNextLoop();
+
+    /// Picks the loop for a connection from @c peerAddr by the selection policy.
+    /// Not thread safe, but in main loop
+    EventLoop *selectLoop(const InetAddress &peerAddr);
 
-        EventLoop *ret = loops_[static_cast<size_t>(next_)];
+    /// Connection gauges of LEAST_CONNECTIONS and POWER_OF_TWO_CHOICES,
+    /// the owner of the connections keeps them up to date.
+    /// Thread safe.
+    void connectionOpened(EventLoop *pLoop) {
+        connections_[indexOf(pLoop)].fetch_add(1, std::memory_order_relaxed);
+    }
 
-        if (++next_ >= nThreads_) {
-            next_ = 0;
-        }
+    /// Thread safe.
+    void connectionClosed(EventLoop *pLoop) {
+        connections_[indexOf(pLoop)].fetch_sub(1, std::memory_order_relaxed);
+    }
 
-        return ret;
+    /// Thread safe.
+    size_t connectionCount(EventLoop *pLoop) const {
+        return connections_[indexOf(pLoop)].load(std::memory_order_relaxed);
+    }
+
+    /// The main loop if there is no thread.
+    const std::vector<EventLoop *> &getAllLoops() const {
+        return loops_;
     }
 
 private:
+    // Busy times are compared over windows of this length
+    static constexpr std::chrono::milliseconds kBusySampleInterval = std::chrono::milliseconds(100);
+
+    size_t indexOf(EventLoop *pLoop) const;
+
+    size_t leastConnections() const;
+
+    size_t leastBusy();
+
+    size_t powerOfTwoChoices();
+
+    size_t peerAddressHash(const InetAddress &peerAddr) const;
+
     EventLoop *pMainLoop_;
     int nThreads_;
 
     int next_ = 0;
 
+    SelectionPolicy policy_ = SelectionPolicy::ROUND_ROBIN;
+
+    std::vector<std::vector<int>> cpusPerThread_;
+    bool bindLocalMemory_ = false;
+
     std::vector<std::unique_ptr<EventLoopThread>> threads_;
-    std::vector<EventLoop *> loops_;
+    std::vector<EventLoop *> loops_;  // only the main loop if there is no thread
+
+    // Indexed as loops_
+    std::unique_ptr<std::atomic<size_t>[]> connections_;
+
+    Timestamp lastBusySample_;
+    std::vector<std::chrono::nanoseconds> lastBusyTimes_;
+    std::vector<std::chrono::nanoseconds> recentBusyTimes_;
+
+    std::minstd_rand random_{std::random_device{}()};
 };
 
 }  // namespace mini_muduo
@@ -2,6 +2,8 @@
 #define MINI_MUDUO_INET_ADDRESS_H
 
 #include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include <cstdint>
 #include <string>
@@ -26,6 +28,18 @@ public:
     explicit InetAddress(const struct sockaddr_in6 &addr)
         : addr6_(addr) {}
 
+    explicit InetAddress(const struct sockaddr_un &addr)
+        : addrUn_(addr) {}
+
+    /// Any of the above, as returned by getsockname() and accept()
+    explicit InetAddress(const struct sockaddr_storage &addr);
+
+    /// Constructs an AF_UNIX endpoint bound to the file @c path,
+    /// or to @c path in the abstract namespace, which needs no file
+    /// and goes away with the last socket. Names longer than
+    /// sun_path are truncated.
+    static InetAddress unixDomain(const std::string &path, bool abstract = false);
+
     InetAddress(const InetAddress &other) = default;
     InetAddress &operator=(const InetAddress &other) = default;
 
@@ -35,10 +49,14 @@ public:
         return addr_.sin_family;
     }
 
+    /// The path of AF_UNIX endpoints, "@name" in the abstract namespace,
+    /// empty if unnamed as the client end of a connection usually is.
     std::string toIp() const;
 
+    /// Same as toIp() for AF_UNIX endpoints.
     std::string toIpPort() const;
 
+    /// 0 for AF_UNIX endpoints.
     uint16_t port() const;
 
     uint16_t portNetEndian() const {
@@ -49,6 +67,9 @@ public:
         return reinterpret_cast<const struct sockaddr *>(&addr6_);
     }
 
+    /// Length of getSockAddr() to pass to bind() and connect().
+    socklen_t getSockAddrLen() const;
+
     void setSockAddrInet6(const struct sockaddr_in6 &addr6) {
         addr6_ = addr6;
     }
@@ -59,6 +80,7 @@ private:
     union {
         struct sockaddr_in addr_;
         struct sockaddr_in6 addr6_;
+        struct sockaddr_un addrUn_;
     };
 };
 
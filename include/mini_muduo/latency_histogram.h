@@ -0,0 +1,80 @@
+#ifndef MINI_MUDUO_LATENCY_HISTOGRAM_H
+#define MINI_MUDUO_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mini_muduo {
+
+/// Latencies counted in power of two microsecond buckets.
+///
+/// Recorded by one thread, relaxed atomics let any other thread read
+/// percentiles while it is running, at the cost of a slightly torn view.
+class LatencyHistogram {
+public:
+    // Bucket i counts latencies below 2^i us, the last one everything above
+    static constexpr size_t kBuckets = 32;
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram &other) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+    void record(std::chrono::nanoseconds latency) {
+        const auto us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+
+        // Bit width of us, 0 for anything below 1 us
+        const auto width = us == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(us));
+        const size_t bucket = width < kBuckets ? width : kBuckets - 1;
+
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        uint64_t total = 0;
+
+        for (const auto &bucket : buckets_) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+
+        return total;
+    }
+
+    /// Upper bound of the bucket holding the @c p quantile, @c p in [0, 1].
+    std::chrono::microseconds percentile(double p) const {
+        const uint64_t total = count();
+
+        if (total == 0) {
+            return std::chrono::microseconds::zero();
+        }
+
+        const auto rank = static_cast<uint64_t>(p * static_cast<double>(total));
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < kBuckets; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+
+            if (seen > rank) {
+                return std::chrono::microseconds(int64_t(1) << i);
+            }
+        }
+
+        return std::chrono::microseconds(int64_t(1) << (kBuckets - 1));
+    }
+
+    void reset() {
+        for (auto &bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+};
+
+}  // namespace mini_muduo
+
+#endif
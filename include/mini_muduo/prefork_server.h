@@ -0,0 +1,153 @@
+#ifndef MINI_MUDUO_PREFORK_SERVER_H
+#define MINI_MUDUO_PREFORK_SERVER_H
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/tcp_connection.h>
+#include <mini_muduo/tcp_server.h>
+#include <mini_muduo/timer_id.h>
+#include <mini_muduo/timestamp.h>
+
+namespace mini_muduo {
+
+class Channel;
+class EventLoop;
+class Socket;
+
+/// Serves one address from worker processes, each running its own TcpServer
+/// with its own loops and heap, so workers share no allocator and a crash
+/// takes down one worker only. The supervisor binds the listening socket,
+/// workers accept from it, connections wait in its backlog while a crashed
+/// worker is restarted. Workers report their stats to the supervisor over
+/// a local socket.
+class PreforkServer {
+public:
+    /// Set up the TcpServer of a worker, called in the worker before it starts.
+    using WorkerInitCallback = std::function<void(TcpServer &)>;
+
+    struct WorkerStats {
+        pid_t pid = 0;  // 0 while it is restarted
+        uint64_t restarts = 0;
+
+        // Open connections at the last report, see TcpServer::getTrafficStats()
+        size_t connections = 0;
+        TrafficCounters traffic;
+        Timestamp reportTime;  // invalid before the first report
+    };
+
+    /// Binds @c listenAddr, abort if address in use. Each worker runs a
+    /// TcpServer with @c nThreadsPerWorker IO threads and @c option, the
+    /// socket has SO_REUSEPORT unless @c option is Option::NO_REUSE_PORT.
+    PreforkServer(EventLoop *pLoop,
+                  const InetAddress &listenAddr,
+                  std::string name,
+                  int nWorkers,
+                  int nThreadsPerWorker = 0,
+                  TcpServer::Option option = TcpServer::Option::NO_REUSE_PORT);
+
+    /// Stops the workers and waits for them to exit, those still running
+    /// after kStopTimeout are killed.
+    /// Not thread safe, but in loop
+    ~PreforkServer();
+
+    PreforkServer(const PreforkServer &other) = delete;
+    PreforkServer &operator=(const PreforkServer &other) = delete;
+
+    /// Not thread safe, call it before start().
+    void setWorkerInitCallback(WorkerInitCallback cb) {
+        workerInitCb_ = std::move(cb);
+    }
+
+    /// How often workers report their stats.
+    /// Not thread safe, call it before start().
+    void setStatsInterval(std::chrono::milliseconds interval) {
+        statsInterval_ = interval;
+    }
+
+    /// How long a crashed worker stays down, keeps one that crashes
+    /// right away from spinning the supervisor.
+    /// Not thread safe, call it before start().
+    void setRestartDelay(std::chrono::milliseconds delay) {
+        restartDelay_ = delay;
+    }
+
+    /// Forks the workers. The loop must not run IO threads of its own
+    /// yet, only the forking thread lives on in a worker. Workers close
+    /// the descriptors of the loop and of its channels.
+    /// Not thread safe, but in loop
+    void start();
+
+    /// Asks the workers to exit with SIGTERM, they close their connections
+    /// and are not restarted.
+    /// Not thread safe, but in loop
+    void stop();
+
+    const std::string &name() const {
+        return name_;
+    }
+
+    /// Indexed by worker.
+    /// Not thread safe, but in loop
+    const std::vector<WorkerStats> &workerStats() const {
+        return stats_;
+    }
+
+    /// Sums of the last reports of all workers, pid is 0.
+    /// Not thread safe, but in loop
+    WorkerStats totalStats() const;
+
+private:
+    static constexpr std::chrono::seconds kStopTimeout = std::chrono::seconds(5);
+
+    struct Worker;
+
+    /// Not thread safe, but in loop
+    void spawnWorker(size_t index);
+
+    /// Not thread safe, but in loop
+    void scheduleRestart(size_t index);
+
+    /// Not thread safe, but in loop
+    void onWorkerExited(size_t index);
+
+    /// Not thread safe, but in loop
+    void onWorkerReport(size_t index);
+
+    /// Not thread safe, but in loop
+    void closeWorker(Worker &worker);
+
+    /// Runs the worker in the forked child.
+    [[noreturn]] void runWorker(size_t index, int reportFd);
+
+    EventLoop *pOwnerLoop_;
+    const std::string name_;
+    const int nThreadsPerWorker_;
+    const TcpServer::Option option_;
+
+    // Pimpl, bound by the supervisor, accepted from by the workers
+    const std::unique_ptr<Socket> listenSocket_;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<WorkerStats> stats_;  // indexed as workers_
+
+    WorkerInitCallback workerInitCb_;
+
+    std::chrono::milliseconds statsInterval_ = std::chrono::seconds(1);
+    std::chrono::milliseconds restartDelay_ = std::chrono::milliseconds(100);
+
+    bool started_ = false;
+    bool stopping_ = false;
+};
+
+}  // namespace mini_muduo
+
+#endif
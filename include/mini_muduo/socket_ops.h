@@ -2,7 +2,11 @@
 #define MINI_MUDUO_SOCKET_OPS_H
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
 #include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <cassert>
@@ -10,6 +14,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include <mini_muduo/endian.h>
 #include <mini_muduo/log.h>
@@ -18,7 +23,8 @@ namespace mini_muduo {
 namespace socket_ops {
 
 inline int createNonblockingOrDie(sa_family_t family) {
-    int sockFd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    const int protocol = family == AF_UNIX ? 0 : IPPROTO_TCP;
+    int sockFd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
 
     if (sockFd < 0) {
         MINI_MUDUO_LOG_CRITITAL("socket()");
@@ -28,8 +34,19 @@ inline int createNonblockingOrDie(sa_family_t family) {
     return sockFd;
 }
 
-inline void bindOrDie(int sockFd, const struct sockaddr *addr) {
-    int ret = ::bind(sockFd, addr, static_cast<socklen_t>(sizeof(struct sockaddr_in6)));
+inline int createNonblockingDatagramOrDie(sa_family_t family) {
+    int sockFd = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (sockFd < 0) {
+        MINI_MUDUO_LOG_CRITITAL("socket()");
+        ::exit(EXIT_FAILURE);
+    }
+
+    return sockFd;
+}
+
+inline void bindOrDie(int sockFd, const struct sockaddr *addr, socklen_t addrlen) {
+    int ret = ::bind(sockFd, addr, addrlen);
 
     if (ret < 0) {
         MINI_MUDUO_LOG_CRITITAL("bind()");
@@ -46,7 +63,7 @@ inline void listenOrDie(int sockFd) {
     }
 }
 
-inline int accept(int sockFd, struct sockaddr_in6 *addr) {
+inline int accept(int sockFd, struct sockaddr_storage *addr) {
     auto addrlen = static_cast<socklen_t>(sizeof(*addr));
     int connFd = ::accept4(sockFd, reinterpret_cast<struct sockaddr *>(addr), &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
@@ -81,8 +98,8 @@ inline int accept(int sockFd, struct sockaddr_in6 *addr) {
     return connFd;
 }
 
-inline int connect(int sockFd, const struct sockaddr *addr) {
-    return ::connect(sockFd, addr, static_cast<socklen_t>(sizeof(struct sockaddr_in6)));
+inline int connect(int sockFd, const struct sockaddr *addr, socklen_t addrlen) {
+    return ::connect(sockFd, addr, addrlen);
 }
 
 inline ssize_t read(int sockFd, void *buf, size_t count) {
@@ -97,6 +114,122 @@ inline ssize_t write(int sockFd, const void *buf, size_t count) {
     return ::write(sockFd, buf, count);
 }
 
+inline ssize_t writev(int sockFd, const struct iovec *iov, int iovcnt) {
+    return ::writev(sockFd, iov, iovcnt);
+}
+
+inline ssize_t sendmsg(int sockFd, const struct iovec *iov, int iovcnt, int flags) {
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = static_cast<size_t>(iovcnt);
+
+    return ::sendmsg(sockFd, &msg, flags);
+}
+
+///
+/// Reads the next MSG_ZEROCOPY completion from the socket error queue,
+/// other queued errors are discarded.
+///
+/// @return false if there is none, otherwise sends up to id @c *hi are done,
+/// @c *copied tells whether the kernel fell back to copying
+bool readZeroCopyCompletion(int sockFd, uint32_t *hi, bool *copied);
+
+inline int recvmmsg(int sockFd, struct mmsghdr *msgs, size_t vlen) {
+    return ::recvmmsg(sockFd, msgs, static_cast<unsigned int>(vlen), 0, nullptr);
+}
+
+inline int sendmmsg(int sockFd, struct mmsghdr *msgs, size_t vlen) {
+    return ::sendmmsg(sockFd, msgs, static_cast<unsigned int>(vlen), MSG_NOSIGNAL);
+}
+
+inline ssize_t sendfile(int sockFd, int inFd, off_t *offset, size_t count) {
+    return ::sendfile(sockFd, inFd, offset, count);
+}
+
+// Moves data between a pipe and another fd inside the kernel
+inline ssize_t splice(int inFd, int outFd, size_t count) {
+    return ::splice(inFd, nullptr, outFd, nullptr, count, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+}
+
+// The kernel's SCM_MAX_FD, descriptors passed by one sendFds()
+inline constexpr size_t kMaxPassedFds = 253;
+
+// Passes @c fds over the Unix domain socket @c unixFd with SCM_RIGHTS,
+// the receiver gets its own descriptors of the same open files
+inline bool sendFds(int unixFd, const std::vector<int> &fds) {
+    assert(!fds.empty() && fds.size() <= kMaxPassedFds);
+
+    // Ancillary data needs at least one byte to travel with
+    char byte = 0;
+    struct iovec iov = {&byte, 1};
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&msg);
+    pCmsg->cmsg_level = SOL_SOCKET;
+    pCmsg->cmsg_type = SCM_RIGHTS;
+    pCmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(pCmsg), fds.data(), sizeof(int) * fds.size());
+
+    ssize_t n;
+
+    do {
+        n = ::sendmsg(unixFd, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+
+    return n == 1;
+}
+
+// Receives descriptors passed by sendFds(), close-on-exec,
+// blocks unless @c unixFd is non-blocking. Empty on error.
+inline std::vector<int> receiveFds(int unixFd) {
+    char byte;
+    struct iovec iov = {&byte, 1};
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * kMaxPassedFds));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t n;
+
+    do {
+        n = ::recvmsg(unixFd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+
+    std::vector<int> fds;
+
+    if (n <= 0) {
+        return fds;
+    }
+
+    for (struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&msg); pCmsg; pCmsg = CMSG_NXTHDR(&msg, pCmsg)) {
+        if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_RIGHTS) {
+            const size_t count = (pCmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const size_t offset = fds.size();
+
+            fds.resize(offset + count);
+            memcpy(fds.data() + offset, CMSG_DATA(pCmsg), sizeof(int) * count);
+        }
+    }
+
+    return fds;
+}
+
 inline void close(int sockFd) {
     if (::close(sockFd) < 0) {
         MINI_MUDUO_LOG_ERROR("close()");
@@ -110,7 +243,26 @@ inline void shutdownWrite(int sockFd) {
 }
 
 inline void toIp(char *buf, size_t size, const struct sockaddr *addr) {
-    if (addr->sa_family == AF_INET) {
+    if (addr->sa_family == AF_UNIX) {
+        auto addrUn = reinterpret_cast<const struct sockaddr_un *>(addr);
+        const size_t maxLen = sizeof(addrUn->sun_path);
+
+        assert(size > maxLen);
+
+        // Abstract names start with a null byte, shown as '@'
+        if (addrUn->sun_path[0] == '\0' && addrUn->sun_path[1] != '\0') {
+            const size_t len = strnlen(addrUn->sun_path + 1, maxLen - 1);
+
+            buf[0] = '@';
+            memcpy(buf + 1, addrUn->sun_path + 1, len);
+            buf[1 + len] = '\0';
+        } else {
+            const size_t len = strnlen(addrUn->sun_path, maxLen);
+
+            memcpy(buf, addrUn->sun_path, len);
+            buf[len] = '\0';
+        }
+    } else if (addr->sa_family == AF_INET) {
         assert(size >= INET_ADDRSTRLEN);
 
         auto addr4 = reinterpret_cast<const struct sockaddr_in *>(addr);
@@ -126,6 +278,11 @@ inline void toIp(char *buf, size_t size, const struct sockaddr *addr) {
 }
 
 inline void toIpPort(char *buf, size_t size, const struct sockaddr *addr) {
+    if (addr->sa_family == AF_UNIX) {
+        toIp(buf, size, addr);
+        return;
+    }
+
     if (addr->sa_family == AF_INET6) {
         buf[0] = '[';
         toIp(buf + 1, size - 1, addr);
@@ -181,8 +338,8 @@ inline int getSocketError(int sockFd) {
     }
 }
 
-inline struct sockaddr_in6 getLocalAddr(int sockFd) {
-    struct sockaddr_in6 localAddr;
+inline struct sockaddr_storage getLocalAddr(int sockFd) {
+    struct sockaddr_storage localAddr;
 
     memset(&localAddr, 0, sizeof(localAddr));
 
@@ -195,8 +352,8 @@ inline struct sockaddr_in6 getLocalAddr(int sockFd) {
     return localAddr;
 }
 
-inline struct sockaddr_in6 getPeerAddr(int sockFd) {
-    struct sockaddr_in6 peerAddr;
+inline struct sockaddr_storage getPeerAddr(int sockFd) {
+    struct sockaddr_storage peerAddr;
 
     memset(&peerAddr, 0, sizeof(peerAddr));
 
@@ -210,17 +367,20 @@ inline struct sockaddr_in6 getPeerAddr(int sockFd) {
 }
 
 inline bool isSelfConnect(int sockFd) {
-    struct sockaddr_in6 localaddr = getLocalAddr(sockFd);
-    struct sockaddr_in6 peeraddr = getPeerAddr(sockFd);
+    struct sockaddr_storage localaddr = getLocalAddr(sockFd);
+    struct sockaddr_storage peeraddr = getPeerAddr(sockFd);
 
-    if (localaddr.sin6_family == AF_INET) {
+    if (localaddr.ss_family == AF_INET) {
         const struct sockaddr_in *laddr4 = reinterpret_cast<struct sockaddr_in *>(&localaddr);
         const struct sockaddr_in *raddr4 = reinterpret_cast<struct sockaddr_in *>(&peeraddr);
         return laddr4->sin_port == raddr4->sin_port && laddr4->sin_addr.s_addr == raddr4->sin_addr.s_addr;
-    } else if (localaddr.sin6_family == AF_INET6) {
-        return localaddr.sin6_port == peeraddr.sin6_port &&
-               memcmp(&localaddr.sin6_addr, &peeraddr.sin6_addr, sizeof localaddr.sin6_addr) == 0;
+    } else if (localaddr.ss_family == AF_INET6) {
+        const struct sockaddr_in6 *laddr6 = reinterpret_cast<struct sockaddr_in6 *>(&localaddr);
+        const struct sockaddr_in6 *raddr6 = reinterpret_cast<struct sockaddr_in6 *>(&peeraddr);
+        return laddr6->sin6_port == raddr6->sin6_port &&
+               memcmp(&laddr6->sin6_addr, &raddr6->sin6_addr, sizeof laddr6->sin6_addr) == 0;
     } else {
+        // A Unix domain socket can not connect to itself
         return false;
     }
 }
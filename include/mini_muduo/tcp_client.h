@@ -70,7 +70,7 @@ private:
     EventLoop *pOwnerLoop_;
     const std::string name_;
 
-    int nextConnId_ = 1;
+    uint64_t nextConnId_ = 1;
     std::atomic<bool> retry_ = false;
     std::atomic<bool> connect_ = true;
 
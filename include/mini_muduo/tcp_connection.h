@@ -1,7 +1,17 @@
 #ifndef MINI_MUDUO_TCP_CONNECTION_H
 #define MINI_MUDUO_TCP_CONNECTION_H
 
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -10,32 +20,85 @@
 #include <mini_muduo/callbacks.h>
 #include <mini_muduo/event_loop.h>
 #include <mini_muduo/inet_address.h>
+#include <mini_muduo/timestamp.h>
 
 namespace mini_muduo {
 
+class OutputQueue;
 class Socket;
+class TcpRelay;
+
+/// Kernel view of a connection, sampled from TCP_INFO.
+struct TcpInfo {
+    Timestamp sampleTime;  // invalid if never sampled
+
+    std::chrono::microseconds rtt{0};  // smoothed
+    std::chrono::microseconds rttVar{0};
+
+    uint32_t congestionWindow = 0;  // segments
+    uint32_t retransmits = 0;       // total over the connection lifetime
+    uint32_t unackedSegments = 0;
+    uint32_t notSentBytes = 0;  // accepted by the kernel, not sent yet
+};
+
+/// Traffic of a connection, plain counters owned by its loop.
+struct TrafficCounters {
+    uint64_t bytesRead = 0;
+    uint64_t messagesRead = 0;  // message callbacks
+    uint64_t bytesWritten = 0;
+    uint64_t messagesWritten = 0;  // send() calls
+    uint64_t writeCalls = 0;       // write(2), writev(2), sendfile(2)...
+    uint64_t partialWrites = 0;    // write calls that left data behind
+    std::chrono::nanoseconds outputQueuedTime{0};  // output queue not empty
+    size_t peakOutputBytes = 0;
+
+    TrafficCounters &operator+=(const TrafficCounters &other) {
+        bytesRead += other.bytesRead;
+        messagesRead += other.messagesRead;
+        bytesWritten += other.bytesWritten;
+        messagesWritten += other.messagesWritten;
+        writeCalls += other.writeCalls;
+        partialWrites += other.partialWrites;
+        outputQueuedTime += other.outputQueuedTime;
+        peakOutputBytes = std::max(peakOutputBytes, other.peakOutputBytes);
+
+        return *this;
+    }
+};
 
 class TcpConnection : public std::enable_shared_from_this<TcpConnection> {
     friend class TcpServer;
     friend class TcpClient;
+    friend class TcpRelay;
 
 public:
-    TcpConnection(
-        EventLoop *pLoop, std::string name, int sockFd, const InetAddress &localAddr, const InetAddress &peerAddr);
+    /// The name is @c namePrefix followed by @c id, built on first use.
+    TcpConnection(EventLoop *pLoop,
+                  uint64_t id,
+                  std::shared_ptr<const std::string> namePrefix,
+                  int sockFd,
+                  const InetAddress &localAddr,
+                  const InetAddress &peerAddr);
 
     ~TcpConnection();
 
     TcpConnection(const TcpConnection &other) = delete;
     TcpConnection &operator=(const TcpConnection &other) = delete;
 
+    /// The loop owning the connection now, see migrateTo().
+    /// Thread safe.
     EventLoop *getLoop() const {
-        return pOwnerIoLoop_;
+        return pOwnerIoLoop_.load(std::memory_order_acquire);
     }
 
-    const std::string &name() const {
-        return name_;
+    /// Unique among the connections of its TcpServer or TcpClient.
+    uint64_t id() const {
+        return id_;
     }
 
+    /// Thread safe.
+    const std::string &name() const;
+
     const InetAddress &localAddress() const {
         return localAddr_;
     }
@@ -49,6 +112,67 @@ public:
         highWaterMark_ = highWaterMarkSize;
     }
 
+    /// Called when the output queue drains to @c lowWaterMarkSize bytes
+    /// after it has reached the high water mark, e.g. to resume a producer.
+    void setLowWaterMarkCallback(LowWaterMarkCallback cb, size_t lowWaterMarkSize) {
+        lowWaterMarkCallback_ = std::move(cb);
+        lowWaterMark_ = lowWaterMarkSize;
+    }
+
+    /// Stops reading while more than @c pauseBytes are queued for output,
+    /// reading is resumed once it drains to @c resumeBytes.
+    /// Keeps a peer which does not read its replies from growing the queue.
+    /// A zero @c pauseBytes disables it.
+    /// Not thread safe, call it in loop or before the connection is established.
+    void setReadBackpressure(size_t pauseBytes, size_t resumeBytes) {
+        assert(resumeBytes <= pauseBytes);
+
+        backpressurePauseBytes_ = pauseBytes;
+        backpressureResumeBytes_ = resumeBytes;
+    }
+
+    /// Releases buffer capacity above @c thresholdBytes once the connection
+    /// has been idle for @c idleTimeout. A zero timeout disables trimming.
+    /// Not thread safe, call it before the connection is established.
+    void setBufferTrimPolicy(std::chrono::milliseconds idleTimeout, size_t thresholdBytes) {
+        bufferTrimIdleTimeout_ = idleTimeout;
+        bufferTrimThreshold_ = thresholdBytes;
+    }
+
+    /// Reads at most @c bytesPerIteration per loop iteration, the rest is left
+    /// in the kernel and read on the next one, after other connections had
+    /// their turn. Keeps one busy peer from delaying the whole loop.
+    /// 0 means no limit.
+    /// Not thread safe, call it in loop or before the connection is established.
+    void setReadBudget(size_t bytesPerIteration) {
+        readBudget_ = bytesPerIteration > 0 ? bytesPerIteration : SIZE_MAX;
+    }
+
+    /// With auto cork, sends only queue data, every connection written to during
+    /// a loop iteration is flushed once at its end with one writev(2).
+    /// Saves syscalls and small segments when a reply is sent in pieces.
+    /// Not thread safe, call it in loop or before the connection is established.
+    void setAutoCork(bool on) {
+        autoCork_ = on;
+    }
+
+    /// Sends owned or shared data of at least @c thresholdBytes with MSG_ZEROCOPY,
+    /// 0 disables it. Their memory is released once the kernel reports completion.
+    /// Not thread safe, call it in loop or before the connection is established.
+    void setZeroCopyThreshold(size_t thresholdBytes);
+
+    /// Bytes sent with MSG_ZEROCOPY which the kernel has not released yet.
+    /// Not thread safe, but in loop
+    size_t zeroCopyPinnedBytes() const;
+
+    /// Bytes waiting in the input buffer and the output queue.
+    /// Not thread safe, but in loop
+    size_t bufferedBytes() const;
+
+    /// Bytes of storage held by the input buffer and the output queue, static data excluded.
+    /// Not thread safe, but in loop
+    size_t reservedBytes() const;
+
     bool connected() const {
         return state_ == State::CONNECTED;
     }
@@ -59,14 +183,82 @@ public:
 
     void send(const void *message, size_t len);
     void send(std::string_view message);
+    void send(const char *message) {
+        send(std::string_view(message));
+    }
+    // Storage is handed to the output queue, no copy, the argument is left empty
+    void send(std::string &&message);
     void send(Buffer &buf);  // this one will swap data
+    void send(Buffer &&buf);
+
+    /// Queues @c message without copying, @c owner keeps it alive until written.
+    /// Useful for one payload broadcast to many connections.
+    void send(std::shared_ptr<const void> owner, std::string_view message);
+
+    /// Queues @c message without copying.
+    /// The data must never be freed, e.g. string literals and static tables.
+    void sendStatic(std::string_view message) {
+        send(nullptr, message);
+    }
+
+    /// Queues @c length bytes of file @c fd from @c offset, streamed with sendfile(2)
+    /// in order with the surrounding send() data.
+    /// @c fd is duplicated, the caller may close it right away.
+    void sendFile(int fd, off_t offset, size_t length);
+
+    /// Writes data held back by auto cork now, rather than at the end of the iteration.
+    /// Thread safe.
+    void flush();
+
+    /// Resumes reading stopped by stopRead().
+    /// Thread safe.
+    void startRead();
+
+    /// Stops reading from the socket, data stays in the kernel and the peer
+    /// is slowed down by TCP flow control.
+    /// Thread safe.
+    void stopRead();
+
+    /// Whether the connection asks for input, see stopRead().
+    /// Not thread safe, but in loop
+    bool isReading() const {
+        return reading_;
+    }
 
     void shutdown();
 
     void forceClose();
 
+    /// Moves the connection to @c pNewLoop, which then runs its callbacks.
+    /// Buffers and callbacks stay as they are, the socket is handed over between
+    /// the pollers of the loops. Sends issued meanwhile follow it in order.
+    /// Ignored unless connected, for relayed connections, and for connections
+    /// of owners which can not move them, i.e. all but TcpServer.
+    /// Thread safe.
+    void migrateTo(EventLoop *pNewLoop);
+
     void setTcpNoDelay(bool on);
 
+    /// Sets TCP_NOTSENT_LOWAT, the socket is writable only while less than
+    /// @c bytes wait unsent in the kernel. Bulk senders keep the rest in the
+    /// output queue, which costs less memory and fewer wake ups.
+    /// 0 restores the system default.
+    void setTcpNotSentLowat(size_t bytes);
+
+    /// Time with queued output includes the current stall, if any.
+    /// Not thread safe, but in loop
+    TrafficCounters trafficCounters() const;
+
+    /// Reads TCP_INFO of the socket into tcpInfo(), returns false on error.
+    /// Not thread safe, but in loop
+    bool sampleTcpInfo();
+
+    /// Last sample, see TcpServer::setTcpInfoSampling().
+    /// Not thread safe, but in loop
+    const TcpInfo &tcpInfo() const {
+        return tcpInfo_;
+    }
+
 private:
     enum class State {
         DISCONNECTED,
@@ -92,6 +284,13 @@ private:
         closeCallback_ = std::move(cb);
     }
 
+    // Called in the old loop before the connection leaves it, false refuses the move
+    using MigrateCallback = std::function<bool(const TcpConnectionPtr &, EventLoop *pNewLoop)>;
+
+    void setMigrateCallback(MigrateCallback cb) {
+        migrateCallback_ = std::move(cb);
+    }
+
     // called when TcpServer accepts a new connection
     void onConnectionEstablished();  // should be called only once
 
@@ -104,17 +303,68 @@ private:
     void handleError();
 
     void sendInLoop(std::string_view message);
+    void sendInLoop(std::string &&message);
+    void sendInLoop(Buffer &&buf);
+    void sendInLoop(std::shared_ptr<const void> owner, std::string_view message);
+    void sendFileInLoop(int fd, off_t offset, size_t length);
+
+    // Writes directly if nothing is queued.
+    // Returns bytes written, or std::nullopt if the connection is broken.
+    std::optional<size_t> tryWriteInLoop(std::string_view message);
+
+    // Bookkeeping after the output queue grew from oldLen bytes
+    void onOutputQueued(size_t oldLen);
+
+    // Bookkeeping after the output queue shrank from oldLen bytes
+    void onOutputDrained(size_t oldLen);
+
+    // Reads only if both the user and backpressure allow it
+    void updateReadingInLoop();
+
+    // Stays in the poller while MSG_ZEROCOPY completions are due,
+    // or reading is paused by the relay and a hang up must still close it
+    void updateRegistrationInLoop();
+
+    // Writes the output queue once, waits for EPOLLOUT only if it can not be drained
+    void flushInLoop();
+    void writeOutputInLoop();
+
+    void scheduleBufferTrim();
+    void trimBuffersIfIdle();
 
     void shutdownInLoop();
 
     void forceCloseInLoop();
 
+    // Runs cb in the loop owning the connection by the time it runs.
+    // Once queued, the connection is kept alive for cb, which may capture this
+    void runInOwnerLoop(EventLoop::Functor cb);
+
+    // Same, after what is already queued, cb gets the queued reference
+    void queueInOwnerLoop(ConnectionCallback cb);
+
+    void migrateInLoop(EventLoop *pNewLoop);
+
+    bool canMigrate() const {
+        return !relay_ && migrateCallback_;
+    }
+
     void setState(State state) {
         state_ = state;
     }
 
-    EventLoop *pOwnerIoLoop_;
-    const std::string name_;
+    // Changes only in migrateInLoop(), read by sends from any thread
+    std::atomic<EventLoop *> pOwnerIoLoop_;
+    const uint64_t id_;
+
+    // Shared by the connections of one server, most never need their name
+    const std::shared_ptr<const std::string> namePrefix_;
+    mutable std::once_flag nameOnce_;
+    mutable std::string name_;
+
+    // Owns this from establishment until after onConnectionDestroyed(), so callbacks
+    // and closures queued in loop can borrow it instead of copying shared_from_this()
+    TcpConnectionPtr self_;
 
     State state_ = State::CONNECTING;
 
@@ -129,12 +379,41 @@ private:
     MessageCallback messageCallback_;
     WriteCompleteCallback writeCompleteCallback_;
     HighWaterMarkCallback highWaterMarkCallback_;
+    LowWaterMarkCallback lowWaterMarkCallback_;
     CloseCallback closeCallback_;
+    MigrateCallback migrateCallback_;
 
     size_t highWaterMark_ = 64 * 1024 * 1024;
+    size_t lowWaterMark_ = 0;
+    bool aboveHighWaterMark_ = false;
+
+    bool reading_ = true;                 // wanted by the user
+    bool readPausedByBackpressure_ = false;
+    bool readPausedByRelay_ = false;
+    size_t backpressurePauseBytes_ = 0;
+    size_t backpressureResumeBytes_ = 0;
+
+    size_t readBudget_ = SIZE_MAX;
+
+    bool autoCork_ = false;
+    bool flushScheduled_ = false;
+
+    std::chrono::milliseconds bufferTrimIdleTimeout_ = std::chrono::milliseconds::zero();
+    size_t bufferTrimThreshold_ = Buffer::kInitialSize;
+    bool bufferTrimScheduled_ = false;
+    Timestamp lastActiveTime_;
+
+    // Allocated on first use, idle connections should not pin any storage
+    Buffer inputBuf_{0};
+    const std::unique_ptr<OutputQueue> outputQueue_;
+
+    TcpInfo tcpInfo_;
+
+    TrafficCounters trafficCounters_;
+    Timestamp outputQueuedSince_;
 
-    Buffer inputBuf_;
-    Buffer outputBuf_;
+    // Set once relayed, takes over reading and writing, see TcpRelay
+    std::shared_ptr<TcpRelay> relay_;
 };
 
 }  // namespace mini_muduo
@@ -0,0 +1,83 @@
+#ifndef MINI_MUDUO_TCP_RELAY_H
+#define MINI_MUDUO_TCP_RELAY_H
+
+#include <cstddef>
+#include <memory>
+
+#include <mini_muduo/callbacks.h>
+
+namespace mini_muduo {
+
+/// Moves bytes between two connections with splice(2), through a pipe
+/// per direction, so relayed data never enters user space.
+///
+/// Data already in the input buffers and output queues goes first.
+/// Reading from one side pauses while its pipe is full, i.e. while the
+/// other side does not keep up. EOF of one side shuts down writing of
+/// the other once the pipe is drained, so half-close works both ways.
+/// If one side closes while the other still sends, the other is closed.
+///
+/// The relay is owned by the two connections and ends with them.
+class TcpRelay {
+public:
+    ~TcpRelay();
+
+    TcpRelay(const TcpRelay &other) = delete;
+    TcpRelay &operator=(const TcpRelay &other) = delete;
+
+    /// Relays between @c first and @c second from now on, their message
+    /// callbacks are no longer called.
+    /// Both must be connected and live in the same loop.
+    /// Not thread safe, but in loop
+    ///
+    /// @return false if no pipe could be created
+    static bool start(const TcpConnectionPtr &first, const TcpConnectionPtr &second);
+
+private:
+    friend class TcpConnection;
+
+    // Pipe size asked for, the kernel may give less
+    static constexpr int kPipeSize = 256 * 1024;
+
+    struct Direction {
+        TcpConnection *pFrom = nullptr;
+        std::weak_ptr<TcpConnection> from;
+        std::weak_ptr<TcpConnection> to;
+
+        int pipeFds[2] = {-1, -1};
+        size_t capacity = 0;
+        size_t pipedBytes = 0;
+        bool eof = false;  // nothing more to read from the source
+    };
+
+    TcpRelay(const TcpConnectionPtr &first, const TcpConnectionPtr &second);
+
+    bool openPipes();
+
+    Direction &directionFrom(const TcpConnection *pConn) {
+        return directions_[0].pFrom == pConn ? directions_[0] : directions_[1];
+    }
+
+    Direction &directionTo(const TcpConnection *pConn) {
+        return directions_[0].pFrom == pConn ? directions_[1] : directions_[0];
+    }
+
+    /// Called by the connections instead of their own handling.
+    void handleRead(TcpConnection *pConn);
+    void handleWrite(TcpConnection *pConn);
+    void handleClose(TcpConnection *pConn);
+
+    // Writes the pipe of @c dir to its destination
+    void pump(Direction &dir);
+
+    // Closes both connections once both directions reached EOF and were drained
+    void closeIfFinished();
+
+    void setSourcePaused(Direction &dir, bool paused);
+
+    Direction directions_[2];
+};
+
+}  // namespace mini_muduo
+
+#endif
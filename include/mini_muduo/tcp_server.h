@@ -1,11 +1,16 @@
 #ifndef MINI_MUDUO_TCP_SERVER_H
 #define MINI_MUDUO_TCP_SERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <mini_muduo/event_loop_thread_pool.h>
 #include <mini_muduo/inet_address.h>
@@ -20,14 +25,64 @@ public:
     enum class Option {
         NO_REUSE_PORT,
         REUSE_PORT,
+        // Every loop listens on its own SO_REUSEPORT socket and keeps its own
+        // connections, accept and close never leave the loop
+        REUSE_PORT_PER_LOOP,
     };
 
+    struct BufferStats {
+        size_t connections = 0;
+        size_t bufferedBytes = 0;  // readable bytes in input and output buffers
+        size_t reservedBytes = 0;  // storage held by input and output buffers, static data excluded
+        size_t pinnedBytes = 0;    // sent with MSG_ZEROCOPY, not yet released by the kernel
+    };
+
+    using BufferStatsCallback = std::function<void(const BufferStats &)>;
+
+    struct LoopTrafficStats {
+        EventLoop *pLoop = nullptr;
+        size_t connections = 0;
+        TrafficCounters total;             // peakOutputBytes is the largest one
+        std::string busiestConnection;     // most bytes read and written
+        std::string mostQueuedConnection;  // longest time with output queued
+    };
+
+    using TrafficStatsCallback = std::function<void(const std::vector<LoopTrafficStats> &)>;
+
+    using DrainedCallback = std::function<void()>;
+
+    struct AdmissionLimits {
+        // Above these new connections are rejected, 0 for no limit
+        size_t maxConnections = 0;
+        size_t maxConnectionsPerLoop = 0;
+
+        // Above these accepting pauses until the loops catch up, zero for never.
+        // See EventLoop::lastIterationTime() and EventLoop::pendingFunctorCount().
+        std::chrono::microseconds maxLoopLag = std::chrono::microseconds::zero();
+        size_t maxPendingFunctors = 0;
+
+        // Written to rejected connections before closing, empty to reset them
+        std::string rejectResponse;
+    };
+
+    /// @c listenAddr may be a Unix domain one, see InetAddress::unixDomain(),
+    /// except with Option::REUSE_PORT_PER_LOOP. TCP options are not set on its connections.
     TcpServer(EventLoop *pLoop,
               const InetAddress &listenAddr,
               std::string name,
               int nThreads = 0,
               Option option = Option::NO_REUSE_PORT);
 
+    /// Listens on sockets bound by another process, see handOver() and
+    /// socket_ops::receiveFds(). One for the main acceptor, one per loop
+    /// with Option::REUSE_PORT_PER_LOOP, loops without one bind a new socket.
+    /// Surplus sockets are closed.
+    TcpServer(EventLoop *pLoop,
+              std::vector<int> listenFds,
+              std::string name,
+              int nThreads = 0,
+              Option option = Option::NO_REUSE_PORT);
+
     ~TcpServer();
 
     TcpServer(const TcpServer &other) = delete;
@@ -57,35 +112,313 @@ public:
         writeCompleteCb_ = std::move(cb);
     }
 
+    /// Release buffer capacity above @c thresholdBytes of connections
+    /// idle for @c idleTimeout, see TcpConnection::setBufferTrimPolicy().
+    /// Not thread safe, applies to connections accepted afterwards.
+    void setIdleBufferTrim(std::chrono::milliseconds idleTimeout, size_t thresholdBytes = Buffer::kInitialSize) {
+        bufferTrimIdleTimeout_ = idleTimeout;
+        bufferTrimThreshold_ = thresholdBytes;
+    }
+
+    /// Send large owned payloads with MSG_ZEROCOPY, see TcpConnection::setZeroCopyThreshold().
+    /// Not thread safe, applies to connections accepted afterwards.
+    void setZeroCopyThreshold(size_t thresholdBytes) {
+        zeroCopyThreshold_ = thresholdBytes;
+    }
+
+    /// Limit bytes read per connection and loop iteration, see TcpConnection::setReadBudget().
+    /// Not thread safe, applies to connections accepted afterwards.
+    void setReadBudget(size_t bytesPerIteration) {
+        readBudget_ = bytesPerIteration;
+    }
+
+    /// Batch writes of each loop iteration, see TcpConnection::setAutoCork().
+    /// Not thread safe, applies to connections accepted afterwards.
+    void setAutoCork(bool on) {
+        autoCork_ = on;
+    }
+
+    /// Set TCP_NOTSENT_LOWAT, see TcpConnection::setTcpNotSentLowat().
+    /// Not thread safe, applies to connections accepted afterwards.
+    void setTcpNotSentLowat(size_t bytes) {
+        tcpNotSentLowat_ = bytes;
+    }
+
+    /// Pick the IO loop of each accepted connection by @c policy,
+    /// see EventLoopThreadPool::SelectionPolicy. Ignored with Option::REUSE_PORT_PER_LOOP,
+    /// the kernel spreads connections over the loops then.
+    /// Not thread safe, call it before start().
+    void setLoopSelection(EventLoopThreadPool::SelectionPolicy policy) {
+        threadPool_.setSelectionPolicy(policy);
+    }
+
+    /// Pins IO thread i to @c cpusPerThread[i % size], see EventLoopThreadPool::setThreadPlacement().
+    /// With Option::REUSE_PORT_PER_LOOP a loop pinned to a single CPU also
+    /// sets SO_INCOMING_CPU on its listening socket, so that connections
+    /// stay on the CPU that receives their packets.
+    /// Not thread safe, call it before start().
+    void setThreadPlacement(std::vector<std::vector<int>> cpusPerThread, bool bindLocalMemory = false) {
+        threadPool_.setThreadPlacement(std::move(cpusPerThread), bindLocalMemory);
+    }
+
+    /// With Option::REUSE_PORT_PER_LOOP, attaches a CBPF program to the reuseport
+    /// group which hands a connection to the listener of the loop pinned to the
+    /// CPU that received its SYN, see setThreadPlacement(). With RSS or RPS
+    /// spreading flows over those CPUs, a connection is then handled by one core
+    /// from the interrupt to the reply. Connections received on other CPUs,
+    /// and all of them if no loop is pinned to a single CPU, are hashed as usual.
+    /// Listeners joining the group later, e.g. those of another process, only
+    /// get connections from CPUs no loop is pinned to.
+    /// Not thread safe, call it before start().
+    void setReusePortCpuSteering(bool on) {
+        reusePortCpuSteering_ = on;
+    }
+
+    /// Accept at most @c maxAccepts connections per readiness event of
+    /// the listening socket, handed to the IO loops as one batch.
+    /// Not thread safe, call it before start().
+    void setMaxAcceptsPerRead(size_t maxAccepts) {
+        maxAcceptsPerRead_ = maxAccepts;
+    }
+
+    /// Samples TCP_INFO of every connection each @c interval, see TcpConnection::tcpInfo().
+    /// One sweep per loop, never a syscall per message.
+    /// Not thread safe, call it before start().
+    void setTcpInfoSampling(std::chrono::milliseconds interval) {
+        tcpInfoSampleInterval_ = interval;
+    }
+
+    /// Rejects or stops accepting connections the loops can not take, see AdmissionLimits.
+    /// Not thread safe, call it before start().
+    void setAdmissionLimits(AdmissionLimits limits) {
+        admissionLimits_ = std::move(limits);
+    }
+
+    /// Each @c interval compares the busy time of the loops, see EventLoop::busyTime().
+    /// If the busiest one was busier than the least busy one by more than
+    /// @c minImbalance of the interval, it migrates to the latter the connection
+    /// with the most traffic since that loop was last looked at, among those
+    /// whose estimated share of the load is below half the difference.
+    /// Larger ones would only move the hot spot. See TcpConnection::migrateTo().
+    /// Not thread safe, call it before start().
+    void setRebalancing(std::chrono::milliseconds interval, double minImbalance = 0.25) {
+        rebalanceInterval_ = interval;
+        rebalanceMinImbalance_ = minImbalance;
+    }
+
+    /// Passes the listening sockets over the Unix domain socket @c unixFd to
+    /// a successor, which adopts them with the listenFds constructor, and
+    /// stops accepting. Connections waiting in the backlog are the successor's,
+    /// none is refused. @c cb is called in the main loop once the connections
+    /// of this server are closed, the server must outlive that.
+    /// Returns false and keeps accepting if the sockets could not be sent.
+    /// With Option::REUSE_PORT_PER_LOOP, waits for every loop to close its acceptor.
+    /// Not thread safe, but in main loop after start()
+    bool handOver(int unixFd, DrainedCallback cb);
+
+    /// Whether the listening sockets have been handed over.
+    /// Thread safe.
+    bool draining() const {
+        return draining_.load(std::memory_order_acquire);
+    }
+
+    /// Open connections of all loops.
+    /// Thread safe.
+    size_t connectionCount() const;
+
+    /// Rounds of accepting, each takes up to setMaxAcceptsPerRead() connections
+    /// and posts them to their loops together.
+    /// Thread safe.
+    uint64_t acceptBatches() const {
+        return acceptBatches_.load(std::memory_order_relaxed);
+    }
+
+    /// Connections rejected by the admission limits.
+    /// Thread safe.
+    uint64_t rejectedConnections() const {
+        return rejectedConnections_.load(std::memory_order_relaxed);
+    }
+
+    /// Times accepting paused as the loops were overloaded.
+    /// Thread safe.
+    uint64_t acceptPauses() const {
+        return acceptPauses_.load(std::memory_order_relaxed);
+    }
+
+    /// Connections moved between loops, by the rebalancer or TcpConnection::migrateTo().
+    /// Thread safe.
+    uint64_t migratedConnections() const {
+        return migratedConnections_.load(std::memory_order_relaxed);
+    }
+
+    /// Sums buffer usage of all connections, each one sampled in its own loop.
+    /// @c cb is called in the main loop.
+    /// Thread safe.
+    void getBufferStats(BufferStatsCallback cb);
+
+    /// Sums traffic counters of the connections per loop, each loop
+    /// summing its own, see TcpConnection::trafficCounters().
+    /// @c cb is called in the main loop.
+    /// Thread safe.
+    void getTrafficStats(TrafficStatsCallback cb);
+
 private:
-    using ConnectionHashMap = std::unordered_map<std::string, TcpConnectionPtr>;
+    // How often a paused acceptor checks whether the loops caught up
+    static constexpr std::chrono::milliseconds kAcceptResumeCheckInterval = std::chrono::milliseconds(10);
+
+    using ConnectionHashMap = std::unordered_map<uint64_t, TcpConnectionPtr>;
+
+    // Set while an acceptor waits for the loops to catch up
+    struct AcceptPause {
+        bool paused = false;
+        TimerId resumeTimer;
+    };
+    using NewConnections = std::vector<std::pair<int, InetAddress>>;  // Acceptor::NewConnections
+
+    // Connections of one loop, only touched in that loop
+    struct LoopShard {
+        // Out of line, Acceptor is incomplete here
+        explicit LoopShard(EventLoop *pShardLoop);
+        ~LoopShard();
+
+        EventLoop *pLoop;
+        std::unique_ptr<Acceptor> acceptor;  // Option::REUSE_PORT_PER_LOOP only
+        ConnectionHashMap connections;
+
+        // Shard i hands out i + 1, i + 1 + n, ... of n shards, no counter is shared
+        uint64_t nextConnId = 0;
+
+        AcceptPause acceptPause;
+
+        // Bytes read and written per connection when the rebalancer last looked
+        std::unordered_map<uint64_t, uint64_t> rebalanceTraffic;
+
+        // Set once the server is destroyed, connections migrating in are closed
+        bool closed = false;
+    };
+
+    using LoopShardPtr = std::shared_ptr<LoopShard>;
+
+    TcpServer(EventLoop *pLoop,
+              const InetAddress &listenAddr,
+              std::string name,
+              int nThreads,
+              Option option,
+              const std::vector<int> &inheritedListenFds);
+
+    /// Not thread safe, but in loop
+    void listenPerLoop();
 
     /// Not thread safe, but in loop
-    void onNewConnection(int sockFd, const InetAddress &peerAddr);
+    void sampleTcpInfo();
 
+    /// Not thread safe, but in loop
+    void onNewConnections(const NewConnections &accepted);
+
+    /// Not thread safe, but in loop of @c pShard
+    void onNewConnectionsInLoop(LoopShard *pShard, const NewConnections &accepted);
+
+    /// Thread safe.
+    TcpConnectionPtr newConnection(LoopShard *pShard, int sockFd, const InetAddress &peerAddr);
+
+    /// Routes close and migration of @c conn to @c pShard.
+    void bindToShard(LoopShard *pShard, const TcpConnectionPtr &conn);
+
+    /// Moves @c conn from @c pShard to the shard of @c pNewLoop, false if there is none.
+    /// Not thread safe, but in loop of @c pShard
+    bool migrateConnectionInLoop(LoopShard *pShard, const TcpConnectionPtr &conn, EventLoop *pNewLoop);
+
+    /// Not thread safe, but in loop
+    void rebalance();
+
+    /// Migrates the connection of @c pShard fitting best into @c gap to @c pNewLoop.
+    /// Not thread safe, but in loop of @c pShard
+    void migrateHottestInLoop(LoopShard *pShard,
+                              EventLoop *pNewLoop,
+                              std::chrono::nanoseconds busyTime,
+                              std::chrono::nanoseconds gap);
+
+    /// Whether the connection limits leave room for one more in @c pIoLoop.
+    /// Thread safe.
+    bool admit(EventLoop *pIoLoop) const;
+
+    /// Thread safe.
+    void reject(int sockFd);
+
+    /// Overload of the loop of @c pShard, or of all loops if it is null.
     /// Thread safe.
-    void removeConnection(const TcpConnectionPtr &conn);
+    bool overloaded(const LoopShard *pShard) const;
+
+    /// The acceptor of @c pShard, or the main one if it is null,
+    /// pauses until overloaded() clears.
+    /// Not thread safe, but in loop of that acceptor
+    void pauseAcceptIfOverloaded(LoopShard *pShard);
+
+    /// Not thread safe, but in loop of that acceptor
+    void scheduleAcceptResumeCheck(LoopShard *pShard);
+
+    /// Not thread safe, but in loop of that acceptor
+    void resumeAcceptIfRecovered(LoopShard *pShard);
+
+    /// Not thread safe, but in loop of @c pShard
+    void removeConnectionInLoop(LoopShard *pShard, const TcpConnectionPtr &conn);
 
     /// Not thread safe, but in loop
-    void removeConnectionInLoop(const TcpConnectionPtr &conn);
+    void callDrainedCallbackIfDrained();
 
     EventLoop *pOwnerMainLoop_;
     const std::string name_;
     const std::string ipPort_;
+    const std::shared_ptr<const std::string> connNamePrefix_;
 
     EventLoopThreadPool threadPool_;
 
     std::once_flag startOnce_;
 
-    // Pimpl
-    const std::unique_ptr<Acceptor> acceptor_;
+    const InetAddress listenAddr_;
+
+    // Listening sockets of another process, adopted by start() with Option::REUSE_PORT_PER_LOOP
+    std::vector<int> inheritedListenFds_;
+
+    // Pimpl, null with Option::REUSE_PORT_PER_LOOP and after handOver()
+    std::unique_ptr<Acceptor> acceptor_;
+
+    // One per loop of the pool, filled by start()
+    std::vector<LoopShardPtr> shards_;
 
     ConnectionCallback connectionCb_ = defaultConnectionCallback;
     MessageCallback messageCb_ = defaultMessageCallback;
     WriteCompleteCallback writeCompleteCb_;
 
-    int nextConnId_ = 1;
-    ConnectionHashMap connections_;
+    std::chrono::milliseconds bufferTrimIdleTimeout_ = std::chrono::milliseconds::zero();
+    size_t bufferTrimThreshold_ = Buffer::kInitialSize;
+    size_t zeroCopyThreshold_ = 0;
+    size_t readBudget_ = 0;
+    bool autoCork_ = false;
+    size_t tcpNotSentLowat_ = 0;
+    size_t maxAcceptsPerRead_ = 0;  // 0 keeps the Acceptor default
+    std::atomic<uint64_t> acceptBatches_ = 0;
+    bool reusePortCpuSteering_ = false;
+
+    std::chrono::milliseconds tcpInfoSampleInterval_ = std::chrono::milliseconds::zero();
+    TimerId tcpInfoTimer_;
+
+    std::chrono::milliseconds rebalanceInterval_ = std::chrono::milliseconds::zero();
+    double rebalanceMinImbalance_ = 0.25;
+    TimerId rebalanceTimer_;
+    std::vector<std::chrono::nanoseconds> rebalanceBusyTimes_;  // indexed as shards_
+    std::atomic<uint64_t> migratedConnections_ = 0;
+
+    AdmissionLimits admissionLimits_;
+    std::atomic<uint64_t> rejectedConnections_ = 0;
+    std::atomic<uint64_t> acceptPauses_ = 0;
+
+    // The main acceptor's, shards keep their own
+    AcceptPause mainAcceptPause_;
+
+    std::atomic<bool> draining_ = false;
+    std::atomic<bool> drainCheckQueued_ = false;
+    DrainedCallback drainedCb_;
 };
 
 }  // namespace mini_muduo
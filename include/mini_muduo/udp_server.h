@@ -0,0 +1,76 @@
+#ifndef MINI_MUDUO_UDP_SERVER_H
+#define MINI_MUDUO_UDP_SERVER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <mini_muduo/event_loop_thread_pool.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/udp_socket.h>
+
+namespace mini_muduo {
+
+/// Receives datagrams on one UdpSocket per loop, all bound to the same
+/// address with SO_REUSEPORT, the kernel spreading peers over them.
+/// Replies go out of the socket passed to the message callback.
+class UdpServer {
+public:
+    UdpServer(EventLoop *pLoop,
+              const InetAddress &listenAddr,
+              std::string name,
+              int nThreads = 0,
+              UdpSocket::Options options = UdpSocket::Options());
+
+    ~UdpServer();
+
+    UdpServer(const UdpServer &other) = delete;
+    UdpServer &operator=(const UdpServer &other) = delete;
+
+    /// Starts the server if it's not receiving.
+    ///
+    /// It's harmless to call it multiple times.
+    /// Thread safe.
+    void start();
+
+    /// Set message callback, called in the loop of the socket.
+    /// Not thread safe.
+    void setMessageCallback(UdpSocket::MessageCallback cb) {
+        messageCb_ = std::move(cb);
+    }
+
+    /// Pins IO thread i to @c cpusPerThread[i % size], see EventLoopThreadPool::setThreadPlacement().
+    /// Not thread safe, call it before start().
+    void setThreadPlacement(std::vector<std::vector<int>> cpusPerThread, bool bindLocalMemory = false) {
+        threadPool_.setThreadPlacement(std::move(cpusPerThread), bindLocalMemory);
+    }
+
+    const std::string &name() const {
+        return name_;
+    }
+
+    /// One per loop, filled by start().
+    const std::vector<std::shared_ptr<UdpSocket>> &sockets() const {
+        return sockets_;
+    }
+
+private:
+    EventLoop *pOwnerMainLoop_;
+    const std::string name_;
+    const InetAddress listenAddr_;
+    const UdpSocket::Options options_;
+
+    EventLoopThreadPool threadPool_;
+
+    std::once_flag startOnce_;
+
+    // Each one is only touched in its own loop
+    std::vector<std::shared_ptr<UdpSocket>> sockets_;
+
+    UdpSocket::MessageCallback messageCb_;
+};
+
+}  // namespace mini_muduo
+
+#endif
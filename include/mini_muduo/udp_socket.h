@@ -0,0 +1,172 @@
+#ifndef MINI_MUDUO_UDP_SOCKET_H
+#define MINI_MUDUO_UDP_SOCKET_H
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/timestamp.h>
+
+namespace mini_muduo {
+
+class Channel;
+class EventLoop;
+class Socket;
+
+/// A bound UDP socket in one loop, receiving datagrams in batches with
+/// recvmmsg() and sending the datagrams of a loop iteration with sendmmsg().
+class UdpSocket {
+public:
+    struct Options {
+        // Datagrams per recvmmsg() and sendmmsg()
+        size_t batchSize = 32;
+
+        // Larger datagrams are truncated, a receive buffer of this size per batch slot
+        size_t maxDatagramSize = 2048;
+
+        bool reusePort = false;
+
+        // UDP_GRO, the kernel hands over datagrams of one flow coalesced,
+        // split again before the message callback. Receive buffers are 64 KiB then.
+        bool gro = false;
+
+        // UDP_SEGMENT, datagrams of one size to one peer queued back to back
+        // are passed to the kernel as one
+        bool gso = false;
+
+        // send() drops datagrams while this much is queued
+        size_t maxQueuedBytes = 4 * 1024 * 1024;
+    };
+
+    struct Stats {
+        uint64_t datagramsReceived = 0;
+        uint64_t datagramsSent = 0;
+        uint64_t datagramsDropped = 0;  // queue full or send error
+        uint64_t datagramsTruncated = 0;
+        uint64_t receiveCalls = 0;
+        uint64_t sendCalls = 0;
+    };
+
+    /// @c data is valid during the call only.
+    using MessageCallback =
+        std::function<void(UdpSocket &, const InetAddress &peerAddr, std::string_view data, Timestamp)>;
+
+    /// Binds @c localAddr, abort if address in use.
+    UdpSocket(EventLoop *pLoop, const InetAddress &localAddr, std::string name, Options options);
+
+    UdpSocket(EventLoop *pLoop, const InetAddress &localAddr, std::string name)
+        : UdpSocket(pLoop, localAddr, std::move(name), Options()) {}
+
+    /// Not thread safe, but in loop
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket &other) = delete;
+    UdpSocket &operator=(const UdpSocket &other) = delete;
+
+    /// Not thread safe.
+    void setMessageCallback(MessageCallback cb) {
+        messageCb_ = std::move(cb);
+    }
+
+    /// Starts receiving.
+    /// Not thread safe, but in loop
+    void start();
+
+    /// Queues a datagram to @c peerAddr, all queued in a loop iteration
+    /// leave with as few sendmmsg() as possible once it ends.
+    /// Returns false if it was dropped as too much is queued.
+    /// Not thread safe, but in loop
+    bool send(const InetAddress &peerAddr, std::string_view data);
+
+    EventLoop *getLoop() const {
+        return pOwnerLoop_;
+    }
+
+    const std::string &name() const {
+        return name_;
+    }
+
+    /// The bound address, with the port picked by the kernel for port 0.
+    const InetAddress &localAddress() const {
+        return localAddr_;
+    }
+
+    /// Whether UDP_GRO and UDP_SEGMENT are in use, off if the kernel refused them.
+    bool groEnabled() const {
+        return options_.gro;
+    }
+
+    bool gsoEnabled() const {
+        return options_.gso;
+    }
+
+    /// Not thread safe, but in loop
+    const Stats &stats() const {
+        return stats_;
+    }
+
+private:
+    struct QueuedDatagram {
+        InetAddress peerAddr;
+        size_t offset;  // in sendBuf_
+        size_t len;
+    };
+
+    void handleRead(Timestamp receiveTime);
+
+    void handleWrite();
+
+    /// Sends queued datagrams until done or EAGAIN.
+    void flush();
+
+    /// Datagrams from @c first on that leave as one GSO message.
+    size_t segmentsFrom(size_t first) const;
+
+    EventLoop *pOwnerLoop_;
+    const std::string name_;
+    Options options_;
+
+    // Pimpl
+    const std::unique_ptr<Socket> socket_;
+    const std::unique_ptr<Channel> channel_;
+
+    InetAddress localAddr_;
+
+    MessageCallback messageCb_;
+
+    // One slot per batch entry, reused by every recvmmsg()
+    size_t receiveSlotSize_;
+    std::vector<char> receiveBuf_;
+    std::vector<struct mmsghdr> receiveMsgs_;
+    std::vector<struct iovec> receiveIovecs_;
+    std::vector<struct sockaddr_storage> receivePeers_;
+    std::vector<char> receiveControl_;
+
+    // Payloads back to back, datagrams index into it
+    std::string sendBuf_;
+    std::vector<QueuedDatagram> sendQueue_;
+    bool flushScheduled_ = false;
+
+    std::vector<struct mmsghdr> sendMsgs_;
+    std::vector<struct iovec> sendIovecs_;
+    std::vector<char> sendControl_;
+    std::vector<size_t> sendSegments_;  // datagrams per message of sendMsgs_
+
+    Stats stats_;
+
+    // A scheduled flush may outlive this socket
+    const std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+};
+
+}  // namespace mini_muduo
+
+#endif
@@ -1,9 +1,11 @@
 #include "acceptor.h"
 
 #include <fcntl.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <cassert>
+#include <cerrno>
 
 #include <mini_muduo/log.h>
 #include <mini_muduo/socket_ops.h>
@@ -17,10 +19,38 @@ Acceptor::Acceptor(EventLoop *pLoop, const InetAddress &listenAddr, bool reusepo
     , idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)) {
     assert(idleFd_ >= 0);
 
-    acceptSocket_.setReuseAddr(true);
-    acceptSocket_.setReusePort(reuseport);
+    if (listenAddr.family() == AF_UNIX) {
+        // A file left by an earlier server would fail bind(), abstract names have none
+        const auto *pAddrUn = reinterpret_cast<const struct sockaddr_un *>(listenAddr.getSockAddr());
+
+        if (pAddrUn->sun_path[0] != '\0') {
+            (void)::unlink(pAddrUn->sun_path);
+        }
+    } else {
+        acceptSocket_.setReuseAddr(true);
+        acceptSocket_.setReusePort(reuseport);
+    }
+
     acceptSocket_.bind(listenAddr);
 
+    init();
+}
+
+Acceptor::Acceptor(EventLoop *pLoop, int listenFd)
+    : pOwnerLoop_(pLoop)
+    , acceptSocket_(listenFd)
+    , acceptChannel_(pLoop, listenFd)
+    , idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)) {
+    assert(idleFd_ >= 0);
+
+    // Status flags belong to the open file, the sender may have had it blocking
+    const int flags = ::fcntl(listenFd, F_GETFL, 0);
+    (void)::fcntl(listenFd, F_SETFL, flags | O_NONBLOCK);
+
+    init();
+}
+
+void Acceptor::init() {
     acceptChannel_.setReadCallback([this](Timestamp receiveTime) {
         (void)receiveTime;
 
@@ -47,19 +77,29 @@ void Acceptor::listen() {
 void Acceptor::handleRead() {
     pOwnerLoop_->assertInLoopThread();
 
-    InetAddress peerAddr;
+    accepted_.clear();
 
-    // FIXME loop until no more
-    const int connFd = acceptSocket_.accept(&peerAddr);
+    while (accepted_.size() < maxAcceptsPerRead_) {
+        InetAddress peerAddr;
 
-    if (connFd >= 0) {
-        if (newConnectionCallback_) {
-            newConnectionCallback_(connFd, peerAddr);
-        } else {
-            socket_ops::close(connFd);
+        const int connFd = acceptSocket_.accept(&peerAddr);
+
+        if (connFd >= 0) {
+            accepted_.emplace_back(connFd, peerAddr);
+            continue;
         }
-    } else {
-        MINI_MUDUO_LOG_ERROR("accept()");
+
+        // Drained
+        if (errno == EAGAIN) {
+            break;
+        }
+
+        // Gone before we got to it
+        if (errno == ECONNABORTED || errno == EINTR) {
+            continue;
+        }
+
+        MINI_MUDUO_LOG_ERROR("accept() {}", strerror_tl(errno));
 
         // Read the section named "The special problem of
         // accept()ing when you can't" in libev's doc.
@@ -70,6 +110,20 @@ void Acceptor::handleRead() {
             ::close(idleFd_);
             idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
         }
+
+        break;
+    }
+
+    if (accepted_.empty()) {
+        return;
+    }
+
+    if (newConnectionsCallback_) {
+        newConnectionsCallback_(accepted_);
+    } else {
+        for (const auto &item : accepted_) {
+            socket_ops::close(item.first);
+        }
     }
 }
 
@@ -1,8 +1,10 @@
 #ifndef MINI_MUDUO_ACCEPTOR_H
 #define MINI_MUDUO_ACCEPTOR_H
 
+#include <cstddef>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "socket.h"
 
@@ -14,25 +16,65 @@ namespace mini_muduo {
 
 class Acceptor {
 public:
-    using NewConnectionCallback = std::function<void(int sockFd, const InetAddress &)>;
+    // Accepted sockets and their peers, owned by the callback
+    using NewConnections = std::vector<std::pair<int, InetAddress>>;
+    using NewConnectionsCallback = std::function<void(const NewConnections &)>;
 
+    static constexpr size_t kDefaultMaxAcceptsPerRead = 16;
+
+    /// A Unix domain @c listenAddr replaces the socket file of an earlier
+    /// server, @c reuseport does not apply to it.
     Acceptor(EventLoop *pLoop, const InetAddress &listenAddr, bool reuseport);
+
+    /// Adopts a bound socket, e.g. one handed over by another process.
+    /// Whatever waits in its backlog is accepted after listen().
+    Acceptor(EventLoop *pLoop, int listenFd);
     ~Acceptor();
 
     Acceptor(const Acceptor &other) = delete;
     Acceptor &operator=(const Acceptor &other) = delete;
 
-    void setNewConnectionCallback(NewConnectionCallback cb) {
-        newConnectionCallback_ = std::move(cb);
+    void setNewConnectionsCallback(NewConnectionsCallback cb) {
+        newConnectionsCallback_ = std::move(cb);
+    }
+
+    /// Accept until EAGAIN, but at most @c maxAccepts per readiness event,
+    /// the rest waits for the next loop iteration.
+    void setMaxAcceptsPerRead(size_t maxAccepts) {
+        maxAcceptsPerRead_ = maxAccepts > 0 ? maxAccepts : 1;
+    }
+
+    void setIncomingCpu(int cpu) {
+        acceptSocket_.setIncomingCpu(cpu);
+    }
+
+    /// See Socket::setReusePortCpuSteering(), applies to the whole group.
+    bool setReusePortCpuSteering(const std::vector<int> &cpuOfListener) {
+        return acceptSocket_.setReusePortCpuSteering(cpuOfListener);
     }
 
     void listen();
 
+    int fd() const {
+        return acceptSocket_.fd();
+    }
+
+    /// Leaves new connections in the backlog until resume().
+    void pause() {
+        acceptChannel_.disableReading();
+    }
+
+    void resume() {
+        acceptChannel_.enableReading();
+    }
+
     bool listening() const {
         return listening_;
     }
 
 private:
+    void init();
+
     void handleRead();
 
     EventLoop *pOwnerLoop_;
@@ -42,7 +84,10 @@ private:
 
     bool listening_ = false;
 
-    NewConnectionCallback newConnectionCallback_;
+    NewConnectionsCallback newConnectionsCallback_;
+
+    size_t maxAcceptsPerRead_ = kDefaultMaxAcceptsPerRead;
+    NewConnections accepted_;
 
     int idleFd_;
 };
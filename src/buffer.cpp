@@ -3,6 +3,8 @@
 
 #include <sys/uio.h>
 
+#include <algorithm>
+
 #include <mini_muduo/socket_ops.h>
 
 namespace mini_muduo {
@@ -12,18 +14,18 @@ const char Buffer::kCRLF[] = "\r\n";
 const size_t Buffer::kCheapPrepend;
 const size_t Buffer::kInitialSize;
 
-ssize_t Buffer::readFd(int fd, int *savedErrno) {
+ssize_t Buffer::readFd(int fd, int *savedErrno, size_t maxBytes) {
     // saved an ioctl()/FIONREAD call to tell how much to read
     char extrabuf[65536];
     struct iovec vec[2];
     const size_t writable = writableBytes();
     vec[0].iov_base = begin() + writerIndex_;
-    vec[0].iov_len = writable;
+    vec[0].iov_len = std::min(writable, maxBytes);
     vec[1].iov_base = extrabuf;
-    vec[1].iov_len = sizeof extrabuf;
+    vec[1].iov_len = std::min(sizeof extrabuf, maxBytes - vec[0].iov_len);
     // when there is enough space in this buffer, don't read into extrabuf.
     // when extrabuf is used, we read 128k-1 bytes at most.
-    const int iovcnt = (writable < sizeof extrabuf) ? 2 : 1;
+    const int iovcnt = (writable < sizeof extrabuf && vec[1].iov_len > 0) ? 2 : 1;
     const ssize_t n = socket_ops::readv(fd, vec, iovcnt);
     if (n < 0) {
         *savedErrno = errno;
@@ -30,7 +30,7 @@ void Connector::startInLoop() {
 
 void Connector::connect() {
     const int sockFd = socket_ops::createNonblockingOrDie(serverAddr_.family());
-    const int connnectRet = socket_ops::connect(sockFd, serverAddr_.getSockAddr());
+    const int connnectRet = socket_ops::connect(sockFd, serverAddr_.getSockAddr(), serverAddr_.getSockAddrLen());
     const int savedErrno = (connnectRet == 0) ? 0 : errno;
 
     switch (savedErrno) {
@@ -46,6 +46,7 @@ void Connector::connect() {
         case EADDRNOTAVAIL:
         case ECONNREFUSED:
         case ENETUNREACH:
+        case ENOENT:  // Unix domain socket not bound yet
             retry(sockFd);
             break;
 
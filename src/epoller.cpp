@@ -90,7 +90,7 @@ void EPoller::updateChannel(Channel *pChannel) {
 
         updateEventCtl(EPOLL_CTL_ADD, pChannel);
     } else if (channelState == ChannelState::ADDED) {
-        if (pChannel->isNoneEvent()) {
+        if (pChannel->isNoneEvent() && !pChannel->keepsRegistered()) {
             pChannel->setState(ChannelState::IGNORED);
 
             updateEventCtl(EPOLL_CTL_DEL, pChannel);
@@ -122,6 +122,15 @@ void EPoller::removeChannel(Channel *pChannel) {
     pChannel->setState(ChannelState::NEW);
 }
 
+void EPoller::closeFdsAfterFork() {
+    // Registered channels only, IGNORED ones included
+    for (const auto &item : channels_) {
+        ::close(item.first);
+    }
+
+    ::close(epollFd_);
+}
+
 void EPoller::updateEventCtl(int operation, Channel *pChannel) {
     const int fd = pChannel->fd();
     struct epoll_event event;
@@ -132,7 +141,7 @@ void EPoller::updateEventCtl(int operation, Channel *pChannel) {
     event.data.fd = fd;
 
     if (::epoll_ctl(epollFd_, operation, fd, &event) != 0) {
-        MINI_MUDUO_LOG_ERROR("epoll_ctl() fd = {}, events = {}", fd, event.events);
+        MINI_MUDUO_LOG_ERROR("epoll_ctl() fd = {}, events = {}", fd, pChannel->concernedEvents());
     }
 }
 
@@ -34,6 +34,9 @@ public:
 
     void removeChannel(Channel *pCannel);
 
+    // See EventLoop::closeFdsAfterFork()
+    void closeFdsAfterFork();
+
 private:
     using ChannelState = Channel::State;
 
@@ -91,10 +91,16 @@ void EventLoop::loop() {
     while (!quit_) {
         auto [timeSinceEpoch, activeChannels] = poller_->poll(kDefaultPollTimeout);
 
+        pollReturnTime_ = timeSinceEpoch;
+
         if (!activeChannels.empty()) {
             handlingEvents_ = true;
 
             for (Channel *pChannel : activeChannels) {
+                if (trackDispatchLatency_) {
+                    dispatchLatency_.record(Timestamp::now().timePoint() - timeSinceEpoch.timePoint());
+                }
+
                 pChannel->handleEvents(timeSinceEpoch);
             }
 
@@ -102,6 +108,12 @@ void EventLoop::loop() {
         }
 
         callPendingFunctors();
+
+        callIterationEndFunctors();
+
+        const auto busy = std::chrono::nanoseconds(Timestamp::now().timePoint() - timeSinceEpoch.timePoint());
+        busyTimeNs_.store(busyTimeNs_.load(std::memory_order_relaxed) + busy.count(), std::memory_order_relaxed);
+        lastIterationNs_.store(busy.count(), std::memory_order_relaxed);
     }
 
     looping_ = false;
@@ -115,6 +127,7 @@ void EventLoop::callPendingFunctors() {
     {
         std::lock_guard lg{mu_};
         functors.swap(pendingFunctors_);
+        pendingFunctorCount_.store(0, std::memory_order_relaxed);
     }
 
     for (const auto &functor : functors) {
@@ -124,6 +137,33 @@ void EventLoop::callPendingFunctors() {
     callingPendingFunctors_ = false;
 }
 
+void EventLoop::callIterationEndFunctors() {
+    if (iterationEndFunctors_.empty()) {
+        return;
+    }
+
+    callingIterationEndFunctors_ = true;
+
+    std::vector<Functor> functors;
+    functors.swap(iterationEndFunctors_);
+
+    for (const auto &functor : functors) {
+        functor();
+    }
+
+    // Keep the storage, this runs every iteration
+    functors.clear();
+
+    if (iterationEndFunctors_.empty()) {
+        iterationEndFunctors_.swap(functors);
+    } else {
+        // Added by the functors above, do not block in poll
+        wakeup();
+    }
+
+    callingIterationEndFunctors_ = false;
+}
+
 void EventLoop::quit() {
     quit_.store(true);
 
@@ -144,13 +184,20 @@ void EventLoop::queueInLoop(Functor cb) {
     {
         std::lock_guard lg{mu_};
         pendingFunctors_.push_back(std::move(cb));
+        pendingFunctorCount_.store(pendingFunctors_.size(), std::memory_order_relaxed);
     }
 
-    if (!isInLoopThread() || callingPendingFunctors_) {
+    if (!isInLoopThread() || callingPendingFunctors_ || callingIterationEndFunctors_) {
         wakeup();
     }
 }
 
+void EventLoop::runAtIterationEnd(Functor cb) {
+    assertInLoopThread();
+
+    iterationEndFunctors_.push_back(std::move(cb));
+}
+
 TimerId EventLoop::runAt(Timestamp time, TimerCallback cb) {
     return timerQueue_->addTimer(std::move(cb), time, std::chrono::milliseconds::zero());
 }
@@ -187,6 +234,11 @@ void EventLoop::removeChannel(Channel *pChannel) {
     poller_->removeChannel(pChannel);
 }
 
+void EventLoop::closeFdsAfterFork() {
+    // The wakeup and timer channels are among them
+    poller_->closeFdsAfterFork();
+}
+
 void EventLoop::abortNotInLoopThread() {
     MINI_MUDUO_LOG_CRITITAL("Must be in loop thread");
     ::exit(EXIT_FAILURE);
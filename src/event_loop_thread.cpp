@@ -0,0 +1,104 @@
+#include <mini_muduo/event_loop_thread.h>
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+
+#include <mini_muduo/log.h>
+
+namespace mini_muduo {
+
+EventLoopThread::~EventLoopThread() {
+    quit();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void EventLoopThread::start() {
+    assert(!thread_.joinable());
+
+    thread_ = std::thread([this] {
+        this->threadFunc();
+    });
+}
+
+EventLoop *EventLoopThread::waitForLoop() {
+    std::unique_lock lg{mu_};
+
+    cond_.wait(lg, [this] {
+        return pCreatedLoop_ != nullptr;
+    });
+
+    return pCreatedLoop_;
+}
+
+void EventLoopThread::quit() {
+    std::lock_guard lg{mu_};
+
+    // Not created yet, threadFunc() sees it then
+    quitRequested_ = true;
+
+    // The loop outlives the lock. Queued rather than quit() directly,
+    // which loop() would reset if it had not started yet.
+    if (pLoop_) {
+        pLoop_->queueInLoop([pLoop = pLoop_] {
+            pLoop->quit();
+        });
+    }
+}
+
+void EventLoopThread::threadFunc() {
+    (void)pthread_setname_np(pthread_self(), name_.c_str());
+
+    applyPlacement();
+
+    EventLoop loop;
+    bool quitRequested;
+
+    {
+        std::lock_guard lg{mu_};
+        pLoop_ = &loop;
+        pCreatedLoop_ = &loop;
+        quitRequested = quitRequested_;
+        cond_.notify_one();
+    }
+
+    // Later requests are queued to the loop, and wake it up
+    if (!quitRequested) {
+        loop.loop();
+    }
+
+    std::lock_guard lg{mu_};
+    pLoop_ = nullptr;
+}
+
+void EventLoopThread::applyPlacement() const {
+    if (!cpus_.empty()) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+
+        for (int cpu : cpus_) {
+            CPU_SET(cpu, &cpuSet);
+        }
+
+        // Returns the error number instead of setting errno
+        const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+
+        if (err != 0) {
+            MINI_MUDUO_LOG_ERROR("EventLoopThread [{}] pthread_setaffinity_np() {}", name_, strerror_tl(err));
+        }
+    }
+
+    // No libnuma for a single call
+    if (bindLocalMemory_ && ::syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) < 0) {
+        MINI_MUDUO_LOG_ERROR("EventLoopThread [{}] set_mempolicy() {}", name_, strerror_tl(errno));
+    }
+}
+
+}  // namespace mini_muduo
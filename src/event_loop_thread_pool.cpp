@@ -0,0 +1,190 @@
+#include <mini_muduo/event_loop_thread_pool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <string_view>
+
+namespace mini_muduo {
+
+EventLoopThreadPool::~EventLoopThreadPool() {
+    // All loops wind down at once, the threads are joined after
+    for (auto &thread : threads_) {
+        thread->quit();
+    }
+
+    threads_.clear();
+}
+
+void EventLoopThreadPool::start() {
+    pMainLoop_->assertInLoopThread();
+
+    for (int i = 0; i < nThreads_; i++) {
+        const std::string threadName = std::string("EventLoopThread#") + std::to_string(i);
+
+        threads_.push_back(std::make_unique<EventLoopThread>(threadName));
+
+        if (!cpusPerThread_.empty()) {
+            threads_.back()->setPlacement(cpusPerThread_[static_cast<size_t>(i) % cpusPerThread_.size()],
+                                          bindLocalMemory_);
+        }
+
+        threads_.back()->start();
+    }
+
+    // Created in parallel, waited for in order
+    for (auto &thread : threads_) {
+        loops_.push_back(thread->waitForLoop());
+    }
+
+    if (nThreads_ == 0) {
+        loops_.push_back(pMainLoop_);
+    }
+
+    lastBusyTimes_.resize(loops_.size());
+    recentBusyTimes_.resize(loops_.size());
+}
+
+EventLoop *EventLoopThreadPool::getNextLoop() {
+    if (nThreads_ == 0) {
+        return pMainLoop_;
+    }
+
+    EventLoop *ret = loops_[static_cast<size_t>(next_)];
+
+    if (++next_ >= nThreads_) {
+        next_ = 0;
+    }
+
+    return ret;
+}
+
+EventLoop *EventLoopThreadPool::selectLoop(const InetAddress &peerAddr) {
+    if (nThreads_ == 0) {
+        return pMainLoop_;
+    }
+
+    switch (policy_) {
+        case SelectionPolicy::ROUND_ROBIN:
+            return getNextLoop();
+        case SelectionPolicy::LEAST_CONNECTIONS:
+            return loops_[leastConnections()];
+        case SelectionPolicy::LEAST_BUSY:
+            return loops_[leastBusy()];
+        case SelectionPolicy::POWER_OF_TWO_CHOICES:
+            return loops_[powerOfTwoChoices()];
+        case SelectionPolicy::PEER_ADDRESS_HASH:
+            // Unix domain peers are mostly unnamed, one hash for all of them
+            if (peerAddr.family() == AF_UNIX) {
+                return getNextLoop();
+            }
+
+            return loops_[peerAddressHash(peerAddr)];
+    }
+
+    return getNextLoop();
+}
+
+const std::vector<int> &EventLoopThreadPool::cpusOf(EventLoop *pLoop) const {
+    static const std::vector<int> kNotPinned;
+
+    if (nThreads_ == 0 || cpusPerThread_.empty()) {
+        return kNotPinned;
+    }
+
+    return cpusPerThread_[indexOf(pLoop) % cpusPerThread_.size()];
+}
+
+size_t EventLoopThreadPool::indexOf(EventLoop *pLoop) const {
+    if (nThreads_ == 0) {
+        return 0;
+    }
+
+    const auto it = std::find(loops_.begin(), loops_.end(), pLoop);
+    assert(it != loops_.end());
+
+    return static_cast<size_t>(it - loops_.begin());
+}
+
+size_t EventLoopThreadPool::leastConnections() const {
+    size_t best = 0;
+
+    for (size_t i = 1; i < loops_.size(); i++) {
+        if (connections_[i].load(std::memory_order_relaxed) < connections_[best].load(std::memory_order_relaxed)) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+size_t EventLoopThreadPool::leastBusy() {
+    const Timestamp now = Timestamp::now();
+
+    if (!lastBusySample_.valid() || now.timePoint() - lastBusySample_.timePoint() >= kBusySampleInterval) {
+        for (size_t i = 0; i < loops_.size(); i++) {
+            const std::chrono::nanoseconds busy = loops_[i]->busyTime();
+
+            recentBusyTimes_[i] = busy - lastBusyTimes_[i];
+            lastBusyTimes_[i] = busy;
+        }
+
+        lastBusySample_ = now;
+    }
+
+    size_t best = 0;
+
+    for (size_t i = 1; i < loops_.size(); i++) {
+        const bool lessBusy = recentBusyTimes_[i] < recentBusyTimes_[best];
+        const bool fewerConnections = recentBusyTimes_[i] == recentBusyTimes_[best] &&
+                                      connections_[i].load(std::memory_order_relaxed) <
+                                          connections_[best].load(std::memory_order_relaxed);
+
+        if (lessBusy || fewerConnections) {
+            best = i;
+        }
+    }
+
+    // The gauge only moves on the next sample, charge the pick with the load
+    // of an average connection so that a burst does not land on one loop
+    const size_t conns = connections_[best].load(std::memory_order_relaxed);
+    recentBusyTimes_[best] += recentBusyTimes_[best] / static_cast<int64_t>(conns + 1);
+
+    return best;
+}
+
+size_t EventLoopThreadPool::powerOfTwoChoices() {
+    const size_t n = loops_.size();
+
+    if (n == 1) {
+        return 0;
+    }
+
+    const size_t first = random_() % n;
+    size_t second = random_() % (n - 1);
+
+    if (second >= first) {
+        second++;
+    }
+
+    return connections_[first].load(std::memory_order_relaxed) <= connections_[second].load(std::memory_order_relaxed)
+               ? first
+               : second;
+}
+
+size_t EventLoopThreadPool::peerAddressHash(const InetAddress &peerAddr) const {
+    std::string_view ip;
+
+    // The port changes on every connection, only the address counts
+    if (peerAddr.family() == AF_INET6) {
+        const auto *pAddr6 = reinterpret_cast<const struct sockaddr_in6 *>(peerAddr.getSockAddr());
+        ip = std::string_view(reinterpret_cast<const char *>(&pAddr6->sin6_addr), sizeof(pAddr6->sin6_addr));
+    } else {
+        const auto *pAddr = reinterpret_cast<const struct sockaddr_in *>(peerAddr.getSockAddr());
+        ip = std::string_view(reinterpret_cast<const char *>(&pAddr->sin_addr), sizeof(pAddr->sin_addr));
+    }
+
+    return std::hash<std::string_view>{}(ip) % loops_.size();
+}
+
+}  // namespace mini_muduo
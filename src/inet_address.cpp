@@ -2,6 +2,8 @@
 
 #include <netdb.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 
 #include <mini_muduo/endian.h>
@@ -10,9 +12,10 @@
 
 namespace mini_muduo {
 
-static_assert(sizeof(InetAddress) == sizeof(struct sockaddr_in6), "InetAddress is same size as sockaddr_in6");
+static_assert(sizeof(InetAddress) <= sizeof(struct sockaddr_storage), "InetAddress fits in sockaddr_storage");
 static_assert(offsetof(sockaddr_in, sin_family) == 0, "sin_family offset 0");
 static_assert(offsetof(sockaddr_in6, sin6_family) == 0, "sin6_family offset 0");
+static_assert(offsetof(sockaddr_un, sun_family) == 0, "sun_family offset 0");
 static_assert(offsetof(sockaddr_in, sin_port) == 2, "sin_port offset 2");
 static_assert(offsetof(sockaddr_in6, sin6_port) == 2, "sin6_port offset 2");
 
@@ -45,20 +48,64 @@ InetAddress::InetAddress(std::string ip, uint16_t portArg, bool ipv6) {
     }
 }
 
+InetAddress::InetAddress(const struct sockaddr_storage &addr) {
+    memcpy(&addrUn_, &addr, sizeof(addrUn_));
+}
+
+/* static */ InetAddress InetAddress::unixDomain(const std::string &path, bool abstract) {
+    struct sockaddr_un addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    // Abstract names start with a null byte, pathnames end with one
+    const size_t offset = abstract ? 1 : 0;
+    const size_t len = std::min(path.size(), sizeof(addr.sun_path) - 1);
+
+    if (len < path.size()) {
+        MINI_MUDUO_LOG_ERROR("InetAddress::unixDomain - {} truncated", path);
+    }
+
+    memcpy(addr.sun_path + offset, path.data(), len);
+
+    return InetAddress(addr);
+}
+
 std::string InetAddress::toIp() const {
-    char buf[64] = "";
+    char buf[sizeof(addrUn_.sun_path) + 1] = "";
     socket_ops::toIp(buf, sizeof buf, getSockAddr());
     return buf;
 }
 
 std::string InetAddress::toIpPort() const {
-    char buf[64] = "";
+    char buf[sizeof(addrUn_.sun_path) + 1] = "";
     socket_ops::toIpPort(buf, sizeof buf, getSockAddr());
     return buf;
 }
 
 uint16_t InetAddress::port() const {
-    return socket_ops::networkToHost16(portNetEndian());
+    return family() == AF_UNIX ? 0 : socket_ops::networkToHost16(portNetEndian());
+}
+
+socklen_t InetAddress::getSockAddrLen() const {
+    switch (family()) {
+        case AF_INET:
+            return static_cast<socklen_t>(sizeof(addr_));
+        case AF_INET6:
+            return static_cast<socklen_t>(sizeof(addr6_));
+        default:
+            break;
+    }
+
+    const size_t pathOffset = offsetof(struct sockaddr_un, sun_path);
+    const size_t maxLen = sizeof(addrUn_.sun_path);
+
+    // The length tells where an abstract name ends, no null byte does
+    if (addrUn_.sun_path[0] == '\0') {
+        return static_cast<socklen_t>(pathOffset + 1 + strnlen(addrUn_.sun_path + 1, maxLen - 1));
+    }
+
+    return static_cast<socklen_t>(pathOffset + strnlen(addrUn_.sun_path, maxLen) + 1);
 }
 
 /* static */ bool InetAddress::resolve(const std::string &hostname, InetAddress &out) {
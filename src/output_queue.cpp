@@ -0,0 +1,351 @@
+#include "output_queue.h"
+
+#include <limits.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+
+#include <mini_muduo/log.h>
+#include <mini_muduo/socket_ops.h>
+
+namespace mini_muduo {
+
+OutputQueue::~OutputQueue() {
+    dropFront(segments_.size() - head_);
+}
+
+size_t OutputQueue::reservedBytes() const {
+    size_t reserved = 0;
+
+    for (size_t i = head_; i < segments_.size(); i++) {
+        const Segment &segment = segments_[i];
+
+        if (const auto *pBuf = std::get_if<Buffer>(&segment)) {
+            reserved += pBuf->internalCapacity();
+        } else if (const auto *pSlice = std::get_if<Slice>(&segment); pSlice && pSlice->owner) {
+            reserved += pSlice->data.size();
+        }
+    }
+
+    return reserved;
+}
+
+void OutputQueue::append(std::string_view data) {
+    if (data.empty()) {
+        return;
+    }
+
+    Buffer *pTail = tailBuffer();
+
+    if (!pTail) {
+        pTail = &std::get<Buffer>(segments_.emplace_back(std::in_place_type<Buffer>, 0));
+    }
+
+    pTail->append(data);
+    readableBytes_ += data.size();
+}
+
+void OutputQueue::append(Buffer &&buf) {
+    if (buf.readableBytes() <= kCoalesceBytes) {
+        append(buf.toStringView());
+        return;
+    }
+
+    if (zeroCopyEligible(buf.readableBytes())) {
+        auto owner = std::make_shared<const Buffer>(std::move(buf));
+        const std::string_view data = owner->toStringView();
+
+        append(std::move(owner), data);
+        return;
+    }
+
+    // Only a drained buffer can be left, not worth keeping
+    if (empty()) {
+        dropFront(segments_.size() - head_);
+    }
+
+    readableBytes_ += buf.readableBytes();
+    segments_.emplace_back(std::move(buf));
+}
+
+void OutputQueue::append(std::shared_ptr<const void> owner, std::string_view data) {
+    if (data.size() <= kCoalesceBytes) {
+        append(data);
+        return;
+    }
+
+    if (empty()) {
+        dropFront(segments_.size() - head_);
+    }
+
+    readableBytes_ += data.size();
+    segments_.emplace_back(Slice{std::move(owner), data, zeroCopyEligible(data.size())});
+}
+
+void OutputQueue::appendFile(int fd, off_t offset, size_t len) {
+    if (len == 0) {
+        socket_ops::close(fd);
+        return;
+    }
+
+    if (empty()) {
+        dropFront(segments_.size() - head_);
+    }
+
+    readableBytes_ += len;
+    segments_.emplace_back(FileRegion{fd, offset, len});
+}
+
+ssize_t OutputQueue::writeFd(int fd, int *savedErrno) {
+    // Only drained buffers can be in front
+    size_t first = head_;
+
+    while (first < segments_.size() && segmentSize(segments_[first]) == 0) {
+        first++;
+    }
+
+    if (first < segments_.size() && std::holds_alternative<FileRegion>(segments_[first])) {
+        return sendFile(fd, savedErrno);
+    }
+
+    const auto isZeroCopy = [this](const Segment &segment) {
+        const auto *pSlice = std::get_if<Slice>(&segment);
+        return pSlice && pSlice->zeroCopy && zeroCopyThreshold_ > 0;
+    };
+
+    // One batch is either all zero copy or all plain memory
+    const bool zeroCopy = first < segments_.size() && isZeroCopy(segments_[first]);
+
+    struct iovec vec[IOV_MAX];
+    int iovcnt = 0;
+
+    for (size_t i = first; i < segments_.size() && iovcnt < IOV_MAX; i++) {
+        const Segment &segment = segments_[i];
+
+        // Memory in front goes first, keep the order
+        if (std::holds_alternative<FileRegion>(segment) || isZeroCopy(segment) != zeroCopy) {
+            break;
+        }
+
+        const std::string_view data = std::holds_alternative<Buffer>(segment)
+                                          ? std::get<Buffer>(segment).toStringView()
+                                          : std::get<Slice>(segment).data;
+
+        if (!data.empty()) {
+            vec[iovcnt].iov_base = const_cast<char *>(data.data());
+            vec[iovcnt].iov_len = data.size();
+            iovcnt++;
+        }
+    }
+
+    if (zeroCopy) {
+        return sendZeroCopy(fd, vec, iovcnt, first, savedErrno);
+    }
+
+    const ssize_t n = socket_ops::writev(fd, vec, iovcnt);
+
+    if (n < 0) {
+        *savedErrno = errno;
+    } else {
+        retrieve(static_cast<size_t>(n));
+    }
+
+    return n;
+}
+
+void OutputQueue::retrieve(size_t len) {
+    assert(len <= readableBytes_);
+
+    readableBytes_ -= len;
+
+    size_t drained = head_;
+
+    for (; drained < segments_.size(); drained++) {
+        Segment &segment = segments_[drained];
+        const size_t n = std::min(len, segmentSize(segment));
+
+        if (auto *pBuf = std::get_if<Buffer>(&segment)) {
+            pBuf->retrieve(n);
+        } else if (auto *pSlice = std::get_if<Slice>(&segment)) {
+            pSlice->data.remove_prefix(n);
+        } else {
+            auto &region = std::get<FileRegion>(segment);
+            region.offset += static_cast<off_t>(n);
+            region.len -= n;
+        }
+
+        len -= n;
+
+        if (segmentSize(segment) > 0) {
+            break;
+        }
+    }
+
+    assert(len == 0);
+
+    // Keep the last buffer when drained, so the next append reuses its storage
+    if (drained == segments_.size() && drained > head_ && std::holds_alternative<Buffer>(segments_.back())) {
+        drained--;
+    }
+
+    dropFront(drained - head_);
+}
+
+void OutputQueue::shrinkToFit() {
+    if (empty()) {
+        dropFront(segments_.size() - head_);
+        std::vector<Segment>().swap(segments_);
+        head_ = 0;
+        return;
+    }
+
+    for (size_t i = head_; i < segments_.size(); i++) {
+        if (auto *pBuf = std::get_if<Buffer>(&segments_[i])) {
+            pBuf->shrinkToFit();
+        }
+    }
+}
+
+/* static */ size_t OutputQueue::segmentSize(const Segment &segment) {
+    if (const auto *pBuf = std::get_if<Buffer>(&segment)) {
+        return pBuf->readableBytes();
+    } else if (const auto *pSlice = std::get_if<Slice>(&segment)) {
+        return pSlice->data.size();
+    } else {
+        return std::get<FileRegion>(segment).len;
+    }
+}
+
+ssize_t OutputQueue::sendFile(int fd, int *savedErrno) {
+    // Only drained buffers can be in front of it
+    const auto it =
+        std::find_if(segments_.begin() + static_cast<std::ptrdiff_t>(head_), segments_.end(), [](const Segment &segment) {
+            return segmentSize(segment) > 0;
+        });
+
+    auto &region = std::get<FileRegion>(*it);
+
+    off_t offset = region.offset;
+    const ssize_t n = socket_ops::sendfile(fd, region.fd, &offset, region.len);
+
+    if (n > 0) {
+        retrieve(static_cast<size_t>(n));
+        return n;
+    }
+
+    if (n == 0) {
+        MINI_MUDUO_LOG_ERROR("sendfile() drops {} bytes of fd {}, file is too short", region.len, region.fd);
+    } else {
+        *savedErrno = errno;
+
+        // Errors of the socket are handled by the connection
+        if (errno == EAGAIN || errno == EINTR || errno == EPIPE || errno == ECONNRESET) {
+            return n;
+        }
+
+        MINI_MUDUO_LOG_ERROR("sendfile() drops {} bytes of fd {}, {}", region.len, region.fd, strerror_tl(errno));
+    }
+
+    readableBytes_ -= region.len;
+    dropFront(static_cast<size_t>(it - segments_.begin()) - head_ + 1);
+
+    return n;
+}
+
+ssize_t OutputQueue::sendZeroCopy(int fd, const struct iovec *vec, int iovcnt, size_t first, int *savedErrno) {
+    ssize_t n = socket_ops::sendmsg(fd, vec, iovcnt, MSG_ZEROCOPY);
+
+    if (n < 0 && errno == ENOBUFS) {
+        // Out of optmem for notifications, copying still works
+        n = socket_ops::writev(fd, vec, iovcnt);
+
+        if (n > 0) {
+            retrieve(static_cast<size_t>(n));
+        }
+    } else if (n > 0) {
+        // Every successful call takes one notification id, even if partially sent
+        ZeroCopySend send{nextZeroCopyId_++, static_cast<size_t>(n), {}};
+
+        size_t covered = 0;
+
+        for (size_t i = first; covered < send.bytes; i++) {
+            const auto &slice = std::get<Slice>(segments_[i]);
+
+            covered += slice.data.size();
+
+            if (slice.owner) {
+                send.owners.push_back(slice.owner);
+            }
+        }
+
+        pinnedBytes_ += send.bytes;
+        zeroCopySends_.push_back(std::move(send));
+
+        retrieve(static_cast<size_t>(n));
+    }
+
+    if (n < 0) {
+        *savedErrno = errno;
+    }
+
+    return n;
+}
+
+void OutputQueue::handleZeroCopyCompletions(int fd) {
+    uint32_t hi = 0;
+    bool copied = false;
+
+    while (socket_ops::readZeroCopyCompletion(fd, &hi, &copied)) {
+        // Completions come in order, ids wrap around
+        auto it = zeroCopySends_.begin();
+
+        for (; it != zeroCopySends_.end() && static_cast<int32_t>(it->id - hi) <= 0; ++it) {
+            pinnedBytes_ -= it->bytes;
+        }
+
+        zeroCopySends_.erase(zeroCopySends_.begin(), it);
+
+        // The kernel copied anyway, e.g. over loopback, MSG_ZEROCOPY only costs more then
+        if (copied && zeroCopyThreshold_ > 0) {
+            MINI_MUDUO_LOG_DEBUG("MSG_ZEROCOPY on fd {} was copied by the kernel, disabled", fd);
+
+            zeroCopyThreshold_ = 0;
+        }
+    }
+}
+
+void OutputQueue::dropFront(size_t count) {
+    assert(head_ + count <= segments_.size());
+
+    for (size_t i = head_; i < head_ + count; i++) {
+        if (const auto *pRegion = std::get_if<FileRegion>(&segments_[i])) {
+            socket_ops::close(pRegion->fd);
+        }
+
+        // Releases buffers and owners now, the placeholder allocates nothing
+        segments_[i] = FileRegion{-1, 0, 0};
+    }
+
+    head_ += count;
+
+    // Erasing from the front for every batch would move the whole queue each time
+    if (head_ == segments_.size()) {
+        segments_.clear();
+        head_ = 0;
+    } else if (head_ * 2 >= segments_.size()) {
+        segments_.erase(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(head_));
+        head_ = 0;
+    }
+}
+
+Buffer *OutputQueue::tailBuffer() {
+    if (segments_.size() == head_) {
+        return nullptr;
+    }
+
+    return std::get_if<Buffer>(&segments_.back());
+}
+
+}  // namespace mini_muduo
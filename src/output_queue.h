@@ -0,0 +1,140 @@
+#ifndef MINI_MUDUO_OUTPUT_QUEUE_H
+#define MINI_MUDUO_OUTPUT_QUEUE_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <mini_muduo/buffer.h>
+
+namespace mini_muduo {
+
+/// Pending output of a TcpConnection.
+///
+/// A queue of segments flushed with one writev(2), so large payloads are
+/// never flattened into a single buffer. Small pieces are still copied
+/// into the tail buffer, an iovec for every few bytes is not worth it.
+/// File regions are streamed with sendfile(2) in queue order.
+///
+/// With zero copy enabled, large slices are sent with MSG_ZEROCOPY and
+/// their owners are kept until the kernel reports completion on the
+/// socket error queue. Buffers are wrapped into slices for that, the
+/// tail buffer is appended to and must never be pinned.
+class OutputQueue {
+public:
+    // Copying smaller pieces is cheaper than a segment of their own
+    static constexpr size_t kCoalesceBytes = 256;
+
+    OutputQueue() = default;
+    ~OutputQueue();
+
+    OutputQueue(const OutputQueue &other) = delete;
+    OutputQueue &operator=(const OutputQueue &other) = delete;
+
+    size_t readableBytes() const {
+        return readableBytes_;
+    }
+
+    bool empty() const {
+        return readableBytes_ == 0;
+    }
+
+    /// Storage held by the queue, static data excluded.
+    /// Shared data counts in full, the queue keeps it alive.
+    size_t reservedBytes() const;
+
+    /// Sends data of at least @c threshold bytes with MSG_ZEROCOPY, 0 disables it.
+    /// SO_ZEROCOPY must be set on the socket.
+    void setZeroCopyThreshold(size_t threshold) {
+        zeroCopyThreshold_ = threshold;
+    }
+
+    bool zeroCopyEligible(size_t len) const {
+        return zeroCopyThreshold_ > 0 && len >= zeroCopyThreshold_;
+    }
+
+    /// Bytes sent with MSG_ZEROCOPY that the kernel has not released yet.
+    size_t pinnedBytes() const {
+        return pinnedBytes_;
+    }
+
+    /// Reads completions from the socket error queue and releases
+    /// the memory they pinned.
+    void handleZeroCopyCompletions(int fd);
+
+    /// Copies @c data into the tail buffer.
+    void append(std::string_view data);
+
+    /// Takes over the storage of @c buf.
+    void append(Buffer &&buf);
+
+    /// Refers to @c data without copying, @c owner keeps it alive.
+    /// A null owner means static data which outlives the queue.
+    void append(std::shared_ptr<const void> owner, std::string_view data);
+
+    /// Takes over @c fd, closed once the region is written or dropped.
+    void appendFile(int fd, off_t offset, size_t len);
+
+    /// Writes as much as possible with one writev(2), or one sendfile(2)
+    /// if a file region is in front, and retrieves it.
+    ///
+    /// @return result of writev(2) or sendfile(2), @c errno is saved
+    ssize_t writeFd(int fd, int *savedErrno);
+
+    void retrieve(size_t len);
+
+    /// Releases unused capacity of the buffers, see Buffer::shrinkToFit().
+    void shrinkToFit();
+
+private:
+    struct Slice {
+        std::shared_ptr<const void> owner;
+        std::string_view data;
+        bool zeroCopy;
+    };
+
+    struct FileRegion {
+        int fd;
+        off_t offset;
+        size_t len;
+    };
+
+    using Segment = std::variant<Buffer, Slice, FileRegion>;
+
+    static size_t segmentSize(const Segment &segment);
+
+    // Owners of a MSG_ZEROCOPY send, released by its completion
+    struct ZeroCopySend {
+        uint32_t id;
+        size_t bytes;
+        std::vector<std::shared_ptr<const void>> owners;
+    };
+
+    ssize_t sendFile(int fd, int *savedErrno);
+
+    ssize_t sendZeroCopy(int fd, const struct iovec *vec, int iovcnt, size_t first, int *savedErrno);
+
+    void dropFront(size_t count);
+
+    Buffer *tailBuffer();
+
+    // Dropping moves head_ forward, the vector is compacted once dropped segments are the majority
+    std::vector<Segment> segments_;
+    size_t head_ = 0;
+    size_t readableBytes_ = 0;
+
+    size_t zeroCopyThreshold_ = 0;
+    uint32_t nextZeroCopyId_ = 0;
+    size_t pinnedBytes_ = 0;
+    std::vector<ZeroCopySend> zeroCopySends_;  // not std::deque, which allocates up front
+};
+
+}  // namespace mini_muduo
+
+#endif
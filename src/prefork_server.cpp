@@ -0,0 +1,451 @@
+#include <mini_muduo/prefork_server.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "socket.h"
+
+#include <mini_muduo/channel.h>
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/log.h>
+#include <mini_muduo/socket_ops.h>
+
+namespace mini_muduo {
+
+namespace {
+
+// One datagram per report, both ends are the same binary
+struct WorkerReport {
+    uint64_t connections;
+    TrafficCounters traffic;
+};
+
+static_assert(std::is_trivially_copyable_v<WorkerReport>);
+
+int pidfdOpenOrDie(pid_t pid) {
+    const auto pidFd = static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+
+    if (pidFd < 0) {
+        MINI_MUDUO_LOG_CRITITAL("pidfd_open() {}", strerror_tl(errno));
+        ::exit(EXIT_FAILURE);
+    }
+
+    return pidFd;
+}
+
+// Whether the pidfd became readable, i.e. the process exited, before the deadline
+bool waitForExit(int pidFd, std::chrono::steady_clock::time_point deadline) {
+    for (;;) {
+        const auto left =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+        struct pollfd pfd = {pidFd, POLLIN, 0};
+        const int n = ::poll(&pfd, 1, static_cast<int>(std::max<int64_t>(left.count(), 0)));
+
+        if (n >= 0 || errno != EINTR) {
+            return n > 0;
+        }
+    }
+}
+
+}  // namespace
+
+struct PreforkServer::Worker {
+    pid_t pid = 0;
+
+    // Readable once the worker exits
+    int pidFd = -1;
+    std::unique_ptr<Channel> exitChannel;
+
+    // The supervisor's end of the report socket
+    int reportFd = -1;
+    std::unique_ptr<Channel> reportChannel;
+
+    bool restartPending = false;
+    TimerId restartTimer;
+};
+
+PreforkServer::PreforkServer(EventLoop *pLoop,
+                             const InetAddress &listenAddr,
+                             std::string name,
+                             int nWorkers,
+                             int nThreadsPerWorker,
+                             TcpServer::Option option)
+    : pOwnerLoop_(pLoop)
+    , name_(std::move(name))
+    , nThreadsPerWorker_(nThreadsPerWorker)
+    , option_(option)
+    , listenSocket_(std::make_unique<Socket>(socket_ops::createNonblockingOrDie(listenAddr.family()))) {
+    assert(nWorkers > 0);
+
+    if (listenAddr.family() == AF_UNIX) {
+        // A file left by an earlier server would fail bind(), abstract names have none
+        const auto *pAddrUn = reinterpret_cast<const struct sockaddr_un *>(listenAddr.getSockAddr());
+
+        if (pAddrUn->sun_path[0] != '\0') {
+            (void)::unlink(pAddrUn->sun_path);
+        }
+    } else {
+        listenSocket_->setReuseAddr(true);
+        listenSocket_->setReusePort(option != TcpServer::Option::NO_REUSE_PORT);
+    }
+
+    listenSocket_->bind(listenAddr);
+
+    // Connections queue up while no worker is accepting
+    listenSocket_->listen();
+
+    for (int i = 0; i < nWorkers; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+
+    stats_.resize(workers_.size());
+}
+
+PreforkServer::~PreforkServer() {
+    pOwnerLoop_->assertInLoopThread();
+
+    stop();
+
+    // One deadline for all, they stop in parallel
+    const auto deadline = std::chrono::steady_clock::now() + kStopTimeout;
+
+    for (auto &worker : workers_) {
+        if (worker->pid > 0) {
+            if (!waitForExit(worker->pidFd, deadline)) {
+                MINI_MUDUO_LOG_WARN(
+                    "PreforkServer [{}] - worker pid = {} still running after SIGTERM, killed", name_, worker->pid);
+
+                (void)::kill(worker->pid, SIGKILL);
+            }
+
+            (void)::waitpid(worker->pid, nullptr, 0);
+            closeWorker(*worker);
+        }
+    }
+}
+
+void PreforkServer::start() {
+    pOwnerLoop_->assertInLoopThread();
+
+    if (started_) {
+        return;
+    }
+
+    started_ = true;
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+        spawnWorker(i);
+    }
+
+    MINI_MUDUO_LOG_INFO("PreforkServer [{}] - {} workers with {} IO threads each",
+                        name_,
+                        workers_.size(),
+                        nThreadsPerWorker_);
+}
+
+void PreforkServer::stop() {
+    pOwnerLoop_->assertInLoopThread();
+
+    stopping_ = true;
+
+    for (auto &worker : workers_) {
+        if (worker->restartPending) {
+            worker->restartPending = false;
+            pOwnerLoop_->cancel(worker->restartTimer);
+        }
+
+        if (worker->pid > 0) {
+            (void)::kill(worker->pid, SIGTERM);
+        }
+    }
+}
+
+PreforkServer::WorkerStats PreforkServer::totalStats() const {
+    WorkerStats total;
+
+    for (const WorkerStats &stats : stats_) {
+        total.restarts += stats.restarts;
+        total.connections += stats.connections;
+        total.traffic += stats.traffic;
+
+        if (stats.reportTime.valid() && (!total.reportTime.valid() || total.reportTime < stats.reportTime)) {
+            total.reportTime = stats.reportTime;
+        }
+    }
+
+    return total;
+}
+
+void PreforkServer::spawnWorker(size_t index) {
+    pOwnerLoop_->assertInLoopThread();
+
+    Worker &worker = *workers_[index];
+    worker.restartPending = false;
+
+    int fds[2];
+
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) < 0) {
+        MINI_MUDUO_LOG_ERROR("PreforkServer::spawnWorker [{}] socketpair() {}", name_, strerror_tl(errno));
+        scheduleRestart(index);
+        return;
+    }
+
+    pid_t pid = -1;
+
+    // Buffered output would be written by both processes
+    std::fflush(nullptr);
+
+    // The child lives on as a copy of the forking thread only, this one has
+    // no loop, so the worker may create its own
+    std::thread([this, index, &pid, &fds] {
+        pid = ::fork();
+
+        if (pid == 0) {
+            ::close(fds[0]);
+            this->runWorker(index, fds[1]);
+        }
+    }).join();
+
+    ::close(fds[1]);
+
+    if (pid < 0) {
+        MINI_MUDUO_LOG_ERROR("PreforkServer::spawnWorker [{}] fork() {}", name_, strerror_tl(errno));
+        ::close(fds[0]);
+        scheduleRestart(index);
+        return;
+    }
+
+    worker.pid = pid;
+    worker.pidFd = pidfdOpenOrDie(pid);
+    worker.reportFd = fds[0];
+
+    worker.exitChannel = std::make_unique<Channel>(pOwnerLoop_, worker.pidFd);
+    worker.exitChannel->setReadCallback([this, index](Timestamp) {
+        this->onWorkerExited(index);
+    });
+    worker.exitChannel->enableReading();
+
+    worker.reportChannel = std::make_unique<Channel>(pOwnerLoop_, worker.reportFd);
+    worker.reportChannel->setReadCallback([this, index](Timestamp) {
+        this->onWorkerReport(index);
+    });
+    worker.reportChannel->enableReading();
+
+    stats_[index].pid = pid;
+
+    MINI_MUDUO_LOG_INFO("PreforkServer::spawnWorker [{}] - worker #{} pid = {}", name_, index + 1, pid);
+}
+
+void PreforkServer::scheduleRestart(size_t index) {
+    if (stopping_) {
+        return;
+    }
+
+    Worker &worker = *workers_[index];
+
+    worker.restartPending = true;
+    worker.restartTimer = pOwnerLoop_->runAfter(restartDelay_, [this, index] {
+        this->spawnWorker(index);
+    });
+}
+
+void PreforkServer::onWorkerExited(size_t index) {
+    pOwnerLoop_->assertInLoopThread();
+
+    Worker &worker = *workers_[index];
+
+    int status = 0;
+    (void)::waitpid(worker.pid, &status, WNOHANG);
+
+    if (stopping_) {
+        MINI_MUDUO_LOG_INFO("PreforkServer::onWorkerExited [{}] - worker #{} pid = {} stopped",
+                            name_,
+                            index + 1,
+                            worker.pid);
+    } else if (WIFSIGNALED(status)) {
+        MINI_MUDUO_LOG_ERROR("PreforkServer::onWorkerExited [{}] - worker #{} pid = {} killed by signal {}",
+                             name_,
+                             index + 1,
+                             worker.pid,
+                             WTERMSIG(status));
+    } else {
+        MINI_MUDUO_LOG_ERROR("PreforkServer::onWorkerExited [{}] - worker #{} pid = {} exited with {}",
+                             name_,
+                             index + 1,
+                             worker.pid,
+                             WEXITSTATUS(status));
+    }
+
+    closeWorker(worker);
+
+    // Its connections are gone with it
+    WorkerStats &stats = stats_[index];
+    stats.pid = 0;
+    stats.connections = 0;
+    stats.traffic = TrafficCounters();
+
+    if (!stopping_) {
+        stats.restarts++;
+        scheduleRestart(index);
+    }
+}
+
+void PreforkServer::onWorkerReport(size_t index) {
+    pOwnerLoop_->assertInLoopThread();
+
+    Worker &worker = *workers_[index];
+
+    // Closed earlier in this iteration, the worker is gone
+    if (!worker.reportChannel) {
+        return;
+    }
+
+    for (;;) {
+        WorkerReport report;
+
+        const ssize_t n = ::recv(worker.reportFd, &report, sizeof(report), 0);
+
+        if (n == static_cast<ssize_t>(sizeof(report))) {
+            WorkerStats &stats = stats_[index];
+            stats.connections = report.connections;
+            stats.traffic = report.traffic;
+            stats.reportTime = Timestamp::now();
+            continue;
+        }
+
+        // The worker is exiting, the pidfd tells when it is gone
+        if (n == 0) {
+            worker.reportChannel->disableAll();
+        } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            MINI_MUDUO_LOG_ERROR("PreforkServer::onWorkerReport [{}] {}", name_, strerror_tl(errno));
+        }
+
+        break;
+    }
+}
+
+void PreforkServer::closeWorker(Worker &worker) {
+    // Can't destroy them here, we may be inside Channel::handleEvents() of one,
+    // and the other may be next among the active channels of this iteration
+    std::shared_ptr<Channel> exitChannel = std::move(worker.exitChannel);
+    std::shared_ptr<Channel> reportChannel = std::move(worker.reportChannel);
+
+    if (exitChannel) {
+        exitChannel->disableAll();
+        exitChannel->remove();
+        ::close(worker.pidFd);
+    }
+
+    if (reportChannel) {
+        reportChannel->disableAll();
+        reportChannel->remove();
+        ::close(worker.reportFd);
+    }
+
+    pOwnerLoop_->queueInLoop([exitChannel, reportChannel] {
+        // Released with this functor, once the events are handled
+    });
+
+    worker.pid = 0;
+    worker.pidFd = -1;
+    worker.reportFd = -1;
+}
+
+void PreforkServer::runWorker(size_t index, int reportFd) {
+    // Never run here. Its descriptors go, with the report sockets and pidfds of the other
+    // workers, so only the supervisor keeps those, and its end of this one hangs up once it is gone
+    pOwnerLoop_->closeFdsAfterFork();
+
+    // Read from a signalfd, the IO threads inherit the mask
+    sigset_t mask;
+    ::sigemptyset(&mask);
+    ::sigaddset(&mask, SIGTERM);
+    ::pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    const int signalFd = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    const int listenFd = ::fcntl(listenSocket_->fd(), F_DUPFD_CLOEXEC, 0);
+
+    if (signalFd < 0 || listenFd < 0) {
+        MINI_MUDUO_LOG_CRITITAL("PreforkServer::runWorker [{}] {}", name_, strerror_tl(errno));
+        ::_exit(EXIT_FAILURE);
+    }
+
+    {
+        EventLoop loop;
+
+        TcpServer server(
+            &loop, std::vector<int>{listenFd}, name_ + "#" + std::to_string(index + 1), nThreadsPerWorker_, option_);
+
+        if (workerInitCb_) {
+            workerInitCb_(server);
+        }
+
+        Channel signalChannel(&loop, signalFd);
+        signalChannel.setReadCallback([&loop, signalFd](Timestamp) {
+            struct signalfd_siginfo info;
+            (void)::read(signalFd, &info, sizeof(info));
+
+            loop.quit();
+        });
+        signalChannel.enableReading();
+
+        Channel reportChannel(&loop, reportFd);
+        reportChannel.setReadCallback([&loop, reportFd](Timestamp) {
+            char dummy;
+
+            // The supervisor is gone, nobody restarts or stops this worker
+            if (::recv(reportFd, &dummy, sizeof(dummy), 0) == 0) {
+                loop.quit();
+            }
+        });
+        reportChannel.enableReading();
+
+        server.start();
+
+        loop.runEvery(statsInterval_, [&server, reportFd] {
+            server.getTrafficStats([reportFd](const std::vector<TcpServer::LoopTrafficStats> &stats) {
+                WorkerReport report{};
+
+                for (const auto &loopStats : stats) {
+                    report.connections += loopStats.connections;
+                    report.traffic += loopStats.total;
+                }
+
+                // Dropped if the supervisor falls behind, the next one replaces it anyway
+                (void)::send(reportFd, &report, sizeof(report), MSG_DONTWAIT | MSG_NOSIGNAL);
+            });
+        });
+
+        loop.loop();
+
+        signalChannel.disableAll();
+        signalChannel.remove();
+        reportChannel.disableAll();
+        reportChannel.remove();
+    }
+
+    spdlog::default_logger()->flush();
+
+    // Nothing of the supervisor is torn down here
+    ::_exit(EXIT_SUCCESS);
+}
+
+}  // namespace mini_muduo
@@ -1,7 +1,13 @@
 #include "socket.h"
 
+#include <linux/filter.h>
+#include <linux/sockios.h>
 #include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <sys/ioctl.h>
 
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 
 #include <mini_muduo/log.h>
@@ -14,7 +20,7 @@ Socket::~Socket() {
 }
 
 void Socket::bind(const InetAddress &addr) const {
-    socket_ops::bindOrDie(sockFd_, addr.getSockAddr());
+    socket_ops::bindOrDie(sockFd_, addr.getSockAddr(), addr.getSockAddrLen());
 }
 
 void Socket::listen() const {
@@ -22,14 +28,14 @@ void Socket::listen() const {
 }
 
 int Socket::accept(InetAddress *peeraddr) const {
-    struct sockaddr_in6 addr;
+    struct sockaddr_storage addr;
 
     memset(&addr, 0, sizeof(addr));
 
     const int connFd = socket_ops::accept(sockFd_, &addr);
 
     if (connFd >= 0) {
-        peeraddr->setSockAddrInet6(addr);
+        *peeraddr = InetAddress(addr);
     }
 
     return connFd;
@@ -58,9 +64,90 @@ void Socket::setReusePort(bool on) const {
     }
 }
 
+void Socket::setIncomingCpu(int cpu) const {
+    if (::setsockopt(sockFd_, SOL_SOCKET, SO_INCOMING_CPU, &cpu, static_cast<socklen_t>(sizeof cpu)) < 0) {
+        MINI_MUDUO_LOG_ERROR("SO_INCOMING_CPU fd = {} {}", sockFd_, strerror_tl(errno));
+    }
+}
+
+bool Socket::setReusePortCpuSteering(const std::vector<int> &cpuOfListener) const {
+    std::vector<struct sock_filter> code;
+
+    // A = CPU that received the SYN
+    code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+
+    for (size_t i = 0; i < cpuOfListener.size(); i++) {
+        if (cpuOfListener[i] < 0) {
+            continue;
+        }
+
+        code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpuOfListener[i]), 0, 1));
+        code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(i)));
+    }
+
+    // Past the end of the group, the kernel falls back to its hash
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, UINT32_MAX));
+
+    struct sock_fprog prog;
+    prog.len = static_cast<unsigned short>(code.size());
+    prog.filter = code.data();
+
+    if (::setsockopt(sockFd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, static_cast<socklen_t>(sizeof prog)) < 0) {
+        MINI_MUDUO_LOG_ERROR("SO_ATTACH_REUSEPORT_CBPF fd = {} {}", sockFd_, strerror_tl(errno));
+        return false;
+    }
+
+    return true;
+}
+
 void Socket::setKeepAlive(bool on) const {
     int optval = on ? 1 : 0;
     ::setsockopt(sockFd_, SOL_SOCKET, SO_KEEPALIVE, &optval, static_cast<socklen_t>(sizeof optval));
 }
 
+bool Socket::setZeroCopy(bool on) const {
+    int optval = on ? 1 : 0;
+    int ret = ::setsockopt(sockFd_, SOL_SOCKET, SO_ZEROCOPY, &optval, static_cast<socklen_t>(sizeof optval));
+
+    if (ret < 0 && on) {
+        MINI_MUDUO_LOG_ERROR("SO_ZEROCOPY fd = {}", sockFd_);
+    }
+
+    return ret == 0;
+}
+
+bool Socket::setUdpGro(bool on) const {
+    int optval = on ? 1 : 0;
+    int ret = ::setsockopt(sockFd_, IPPROTO_UDP, UDP_GRO, &optval, static_cast<socklen_t>(sizeof optval));
+
+    if (ret < 0 && on) {
+        MINI_MUDUO_LOG_ERROR("UDP_GRO fd = {}", sockFd_);
+    }
+
+    return ret == 0;
+}
+
+void Socket::setTcpNotSentLowat(size_t bytes) const {
+    // 0 falls back to the net.ipv4.tcp_notsent_lowat sysctl, -1 would be UINT_MAX
+    int optval = static_cast<int>(bytes);
+    int ret = ::setsockopt(sockFd_, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &optval, static_cast<socklen_t>(sizeof optval));
+
+    if (ret < 0) {
+        MINI_MUDUO_LOG_ERROR("TCP_NOTSENT_LOWAT fd = {}", sockFd_);
+    }
+}
+
+bool Socket::getTcpInfo(struct tcp_info *pInfo) const {
+    socklen_t len = sizeof(*pInfo);
+    memset(pInfo, 0, len);
+
+    return ::getsockopt(sockFd_, SOL_TCP, TCP_INFO, pInfo, &len) == 0;
+}
+
+int Socket::getNotSentBytes() const {
+    int bytes = 0;
+
+    return ::ioctl(sockFd_, SIOCOUTQNSD, &bytes) == 0 ? bytes : -1;
+}
+
 }  // namespace mini_muduo
@@ -1,8 +1,13 @@
 #ifndef MINI_MUDUO_SOCKET_H
 #define MINI_MUDUO_SOCKET_H
 
+#include <cstddef>
+#include <vector>
+
 #include <mini_muduo/inet_address.h>
 
+struct tcp_info;
+
 namespace mini_muduo {
 
 class Socket {
@@ -53,6 +58,40 @@ public:
     ///
     void setKeepAlive(bool on) const;
 
+    ///
+    /// Enable/disable SO_ZEROCOPY, returns false if not supported
+    ///
+    bool setZeroCopy(bool on) const;
+
+    ///
+    /// Set TCP_NOTSENT_LOWAT, 0 restores the system default
+    ///
+    void setTcpNotSentLowat(size_t bytes) const;
+
+    ///
+    /// Set SO_INCOMING_CPU, a reuseport group then prefers the listener of
+    /// the CPU which received the SYN
+    ///
+    void setIncomingCpu(int cpu) const;
+
+    ///
+    /// Attach a SO_ATTACH_REUSEPORT_CBPF program to the reuseport group, sending
+    /// connections received on CPU @c cpuOfListener[i] to the i-th listener of
+    /// the group, in the order they called listen(). Negative entries and other
+    /// CPUs are left to the kernel hash. Returns false if not supported
+    ///
+    bool setReusePortCpuSteering(const std::vector<int> &cpuOfListener) const;
+
+    ///
+    /// Enable/disable UDP_GRO, returns false if not supported
+    ///
+    bool setUdpGro(bool on) const;
+
+    bool getTcpInfo(struct tcp_info *pInfo) const;
+
+    /// Bytes in the send queue not sent yet, -1 on error
+    int getNotSentBytes() const;
+
 private:
     const int sockFd_;
 };
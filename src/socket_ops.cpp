@@ -0,0 +1,46 @@
+#include <mini_muduo/socket_ops.h>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+
+#include <cstring>
+
+namespace mini_muduo {
+namespace socket_ops {
+
+bool readZeroCopyCompletion(int sockFd, uint32_t *hi, bool *copied) {
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+    struct msghdr msg;
+
+    while (true) {
+        memset(&msg, 0, sizeof(msg));
+
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(sockFd, &msg, MSG_ERRQUEUE) < 0) {
+            return false;
+        }
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            const bool isRecvErr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                                   (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+
+            if (!isRecvErr) {
+                continue;
+            }
+
+            struct sock_extended_err serr;
+            memcpy(&serr, CMSG_DATA(cmsg), sizeof(serr));
+
+            if (serr.ee_errno == 0 && serr.ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                *hi = serr.ee_data;
+                *copied = serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED;
+                return true;
+            }
+        }
+    }
+}
+
+}  // namespace socket_ops
+}  // namespace mini_muduo
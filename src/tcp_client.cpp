@@ -92,15 +92,13 @@ void TcpClient::onNewConnection(int sockFd) {
     pOwnerLoop_->assertInLoopThread();
 
     const InetAddress peerAddr(socket_ops::getPeerAddr(sockFd));
-    char buf[32];
-    snprintf(buf, sizeof buf, ":%s#%d", peerAddr.toIpPort().c_str(), nextConnId_++);
-
-    const std::string connName = name_ + buf;
+    const auto namePrefix = std::make_shared<const std::string>(name_ + ":" + peerAddr.toIpPort() + "#");
 
     const InetAddress localAddr(socket_ops::getLocalAddr(sockFd));
 
     // FIXME poll with zero timeout to double confirm the new connection
-    const auto conn = std::make_shared<TcpConnection>(pOwnerLoop_, connName, sockFd, localAddr, peerAddr);
+    const auto conn =
+        std::make_shared<TcpConnection>(pOwnerLoop_, nextConnId_++, namePrefix, sockFd, localAddr, peerAddr);
 
     conn->setConnectionCallback(connectionCb_);
     conn->setMessageCallback(messageCb_);
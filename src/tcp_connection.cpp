@@ -1,17 +1,24 @@
 #include <mini_muduo/tcp_connection.h>
 
+#include <fcntl.h>
+#include <netinet/tcp.h>
+
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstring>
 #include <memory>
 #include <utility>
 
+#include "output_queue.h"
 #include "socket.h"
 
 #include <mini_muduo/channel.h>
 #include <mini_muduo/event_loop.h>
 #include <mini_muduo/log.h>
 #include <mini_muduo/socket_ops.h>
+#include <mini_muduo/tcp_relay.h>
 #include <mini_muduo/timestamp.h>
 
 namespace mini_muduo {
@@ -31,14 +38,20 @@ void defaultMessageCallback(const TcpConnectionPtr &, Buffer &buf, Timestamp) {
     buf.retrieveAll();
 }
 
-TcpConnection::TcpConnection(
-    EventLoop *pLoop, std::string name, int sockFd, const InetAddress &localAddr, const InetAddress &peerAddr)
+TcpConnection::TcpConnection(EventLoop *pLoop,
+                             uint64_t id,
+                             std::shared_ptr<const std::string> namePrefix,
+                             int sockFd,
+                             const InetAddress &localAddr,
+                             const InetAddress &peerAddr)
     : pOwnerIoLoop_(pLoop)
-    , name_(std::move(name))
+    , id_(id)
+    , namePrefix_(std::move(namePrefix))
     , socket_(std::make_unique<Socket>(sockFd))
     , channel_(std::make_unique<Channel>(pLoop, sockFd))
     , localAddr_(localAddr)
-    , peerAddr_(peerAddr) {
+    , peerAddr_(peerAddr)
+    , outputQueue_(std::make_unique<OutputQueue>()) {
     channel_->setReadCallback([this](Timestamp receiveTime) {
         this->handleRead(receiveTime);
     });
@@ -55,20 +68,28 @@ TcpConnection::TcpConnection(
         this->handleError();
     });
 
-    MINI_MUDUO_LOG_DEBUG("TcpConnection::ctor[{}], fd = {}", name_, sockFd);
+    MINI_MUDUO_LOG_DEBUG("TcpConnection::ctor[#{}], fd = {}", id_, sockFd);
 
     socket_->setKeepAlive(true);
 }
 
 TcpConnection::~TcpConnection() {
     MINI_MUDUO_LOG_DEBUG(
-        "TcpConnection::dtor[{}], fd = {}, state = {}", name_, socket_->fd(), static_cast<int>(state_));
+        "TcpConnection::dtor[#{}], fd = {}, state = {}", id_, socket_->fd(), static_cast<int>(state_));
 
     assert(state_ == State::DISCONNECTED);
 }
 
+const std::string &TcpConnection::name() const {
+    std::call_once(nameOnce_, [this] {
+        name_ = *namePrefix_ + std::to_string(id_);
+    });
+
+    return name_;
+}
+
 void TcpConnection::onConnectionEstablished() {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
 
     assert(state_ == State::CONNECTING);
 
@@ -80,13 +101,15 @@ void TcpConnection::onConnectionEstablished() {
 
     // No need to tie()???
     // channel_->tie(shared_from_this());
-    channel_->enableReading();
+    updateReadingInLoop();
 
-    connectionCallback_(shared_from_this());
+    self_ = shared_from_this();
+
+    connectionCallback_(self_);
 }
 
 void TcpConnection::onConnectionDestroyed() {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
 
     // Maybe be force closed before
     if (state_ == State::CONNECTED) {
@@ -94,10 +117,17 @@ void TcpConnection::onConnectionDestroyed() {
 
         channel_->disableAll();
 
-        connectionCallback_(shared_from_this());
+        connectionCallback_(self_);
     }
 
     channel_->remove();
+
+    // Closures queued so far borrow this, let go after them.
+    // Nothing queues new ones, the channel is gone.
+    getLoop()->queueInLoop([this] {
+        TcpConnectionPtr self;
+        self.swap(self_);
+    });
 }
 
 void TcpConnection::send(const void *data, size_t len) {
@@ -109,97 +139,420 @@ void TcpConnection::send(std::string_view message) {
         return;
     }
 
-    if (pOwnerIoLoop_->isInLoopThread()) {
+    if (getLoop()->isInLoopThread()) {
         sendInLoop(message);
     } else {
-        pOwnerIoLoop_->runInLoop([shared_this = shared_from_this(), message = std::string(message)] {
-            shared_this->sendInLoop(message);
+        runInOwnerLoop([this, message = std::string(message)] {
+            this->sendInLoop(message);
+        });
+    }
+}
+
+void TcpConnection::send(std::string &&message) {
+    // A moved from string is unspecified, this one is left empty
+    std::string data;
+    data.swap(message);
+
+    if (state_ != State::CONNECTED) {
+        return;
+    }
+
+    if (getLoop()->isInLoopThread()) {
+        sendInLoop(std::move(data));
+    } else {
+        // mutable: sendInLoop() takes over the storage
+        runInOwnerLoop([this, data = std::move(data)]() mutable {
+            this->sendInLoop(std::move(data));
         });
     }
 }
 
-// FIXME efficiency!!!
 void TcpConnection::send(Buffer &buf) {
+    send(std::move(buf));
+}
+
+void TcpConnection::send(Buffer &&buf) {
+    Buffer data(0);
+    data.swap(buf);
+
     if (state_ != State::CONNECTED) {
         return;
     }
 
-    if (pOwnerIoLoop_->isInLoopThread()) {
-        sendInLoop(buf.toStringView());
-        buf.retrieveAll();
+    if (getLoop()->isInLoopThread()) {
+        sendInLoop(std::move(data));
     } else {
-        pOwnerIoLoop_->runInLoop([shared_this = shared_from_this(), message = buf.retrieveAllAsString()] {
-            shared_this->sendInLoop(message);
+        // mutable: sendInLoop() takes over the storage
+        runInOwnerLoop([this, data = std::move(data)]() mutable {
+            this->sendInLoop(std::move(data));
+        });
+    }
+}
+
+void TcpConnection::send(std::shared_ptr<const void> owner, std::string_view message) {
+    if (state_ != State::CONNECTED) {
+        return;
+    }
+
+    if (getLoop()->isInLoopThread()) {
+        sendInLoop(std::move(owner), message);
+    } else {
+        runInOwnerLoop([this, owner = std::move(owner), message] {
+            this->sendInLoop(owner, message);
+        });
+    }
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length) {
+    if (state_ != State::CONNECTED) {
+        return;
+    }
+
+    const int dupFd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+
+    if (dupFd < 0) {
+        MINI_MUDUO_LOG_ERROR("TcpConnection::sendFile[{}] dup fd {} {}", name(), fd, strerror_tl(errno));
+        return;
+    }
+
+    if (getLoop()->isInLoopThread()) {
+        sendFileInLoop(dupFd, offset, length);
+    } else {
+        runInOwnerLoop([this, dupFd, offset, length] {
+            this->sendFileInLoop(dupFd, offset, length);
         });
     }
 }
 
 void TcpConnection::sendInLoop(std::string_view message) {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
+
+    if (state_ == State::DISCONNECTED) {
+        MINI_MUDUO_LOG_WARN("Already Disconnnected");
+        return;
+    }
+
+    trafficCounters_.messagesWritten++;
+
+    const std::optional<size_t> nwrote = tryWriteInLoop(message);
+
+    if (nwrote && *nwrote < message.size()) {
+        const size_t oldLen = outputQueue_->readableBytes();
+
+        outputQueue_->append(message.substr(*nwrote));
+
+        onOutputQueued(oldLen);
+    }
+}
+
+void TcpConnection::sendInLoop(std::string &&message) {
+    getLoop()->assertInLoopThread();
+
+    if (state_ == State::DISCONNECTED) {
+        MINI_MUDUO_LOG_WARN("Already Disconnnected");
+        return;
+    }
+
+    trafficCounters_.messagesWritten++;
+
+    // Zero copy sends wait for EPOLLOUT, a direct write would copy
+    const std::optional<size_t> nwrote =
+        outputQueue_->zeroCopyEligible(message.size()) ? std::optional<size_t>(0) : tryWriteInLoop(message);
+
+    if (nwrote && *nwrote < message.size()) {
+        const size_t oldLen = outputQueue_->readableBytes();
+
+        // Moving the string keeps its heap storage where it is
+        auto owner = std::make_shared<const std::string>(std::move(message));
+        const std::string_view remaining = std::string_view(*owner).substr(*nwrote);
+
+        outputQueue_->append(std::move(owner), remaining);
+
+        onOutputQueued(oldLen);
+    }
+}
+
+void TcpConnection::sendInLoop(Buffer &&buf) {
+    getLoop()->assertInLoopThread();
+
+    if (state_ == State::DISCONNECTED) {
+        MINI_MUDUO_LOG_WARN("Already Disconnnected");
+        return;
+    }
+
+    trafficCounters_.messagesWritten++;
+
+    const std::optional<size_t> nwrote = outputQueue_->zeroCopyEligible(buf.readableBytes())
+                                             ? std::optional<size_t>(0)
+                                             : tryWriteInLoop(buf.toStringView());
+
+    if (nwrote && *nwrote < buf.readableBytes()) {
+        const size_t oldLen = outputQueue_->readableBytes();
+
+        buf.retrieve(*nwrote);
+        outputQueue_->append(std::move(buf));
+
+        onOutputQueued(oldLen);
+    }
+}
+
+void TcpConnection::sendInLoop(std::shared_ptr<const void> owner, std::string_view message) {
+    getLoop()->assertInLoopThread();
+
+    if (state_ == State::DISCONNECTED) {
+        MINI_MUDUO_LOG_WARN("Already Disconnnected");
+        return;
+    }
+
+    trafficCounters_.messagesWritten++;
+
+    const std::optional<size_t> nwrote =
+        outputQueue_->zeroCopyEligible(message.size()) ? std::optional<size_t>(0) : tryWriteInLoop(message);
+
+    if (nwrote && *nwrote < message.size()) {
+        const size_t oldLen = outputQueue_->readableBytes();
+
+        outputQueue_->append(std::move(owner), message.substr(*nwrote));
+
+        onOutputQueued(oldLen);
+    }
+}
+
+void TcpConnection::sendFileInLoop(int fd, off_t offset, size_t length) {
+    getLoop()->assertInLoopThread();
 
     if (state_ == State::DISCONNECTED) {
         MINI_MUDUO_LOG_WARN("Already Disconnnected");
+        socket_ops::close(fd);
         return;
     }
 
-    const void *data = message.data();
-    const size_t len = message.size();
+    trafficCounters_.messagesWritten++;
+
+    const size_t oldLen = outputQueue_->readableBytes();
 
-    ssize_t nwrote = 0;
-    size_t remaining = len;
-    bool faultError = false;
+    // Streamed by handleWrite(), the socket is writable right away if nothing is queued
+    outputQueue_->appendFile(fd, offset, length);
+
+    onOutputQueued(oldLen);
+}
 
+std::optional<size_t> TcpConnection::tryWriteInLoop(std::string_view message) {
     // if nothing in output queue, try writing directly
-    if (!channel_->isWriting() && outputBuf_.readableBytes() == 0) {
-        nwrote = socket_ops::write(channel_->fd(), data, len);
+    if (autoCork_ || channel_->isWriting() || !outputQueue_->empty()) {
+        return 0;
+    }
 
-        if (nwrote >= 0) {
-            remaining = len - static_cast<size_t>(nwrote);
+    const ssize_t nwrote = socket_ops::write(channel_->fd(), message.data(), message.size());
 
-            if (remaining == 0 && writeCompleteCallback_) {
-                pOwnerIoLoop_->queueInLoop([shared_this = shared_from_this()] {
-                    shared_this->writeCompleteCallback_(shared_this);
-                });
-            }
-        } else {  // nwrote < 0
-            nwrote = 0;
+    trafficCounters_.writeCalls++;
 
-            if (errno != EWOULDBLOCK) {
-                if (errno == EPIPE || errno == ECONNRESET) {  // FIXME: any others?
-                    faultError = true;
-                }
-            }
+    if (nwrote < 0 || static_cast<size_t>(nwrote) < message.size()) {
+        trafficCounters_.partialWrites++;
+    }
+
+    if (nwrote >= 0) {
+        lastActiveTime_ = getLoop()->pollReturnTime();
+        trafficCounters_.bytesWritten += static_cast<size_t>(nwrote);
+
+        if (static_cast<size_t>(nwrote) == message.size() && writeCompleteCallback_) {
+            queueInOwnerLoop([this](const TcpConnectionPtr &conn) {
+                this->writeCompleteCallback_(conn);
+            });
         }
+
+        return static_cast<size_t>(nwrote);
     }
 
-    assert(remaining <= len);
+    if (errno != EWOULDBLOCK) {
+        if (errno == EPIPE || errno == ECONNRESET) {  // FIXME: any others?
+            return std::nullopt;
+        }
+    }
+
+    return 0;
+}
 
-    if (!faultError && remaining > 0) {
-        const size_t oldLen = outputBuf_.readableBytes();
+void TcpConnection::onOutputQueued(size_t oldLen) {
+    const size_t newLen = outputQueue_->readableBytes();
 
-        outputBuf_.append(static_cast<const char *>(data) + nwrote, remaining);
+    if (oldLen == 0) {
+        outputQueuedSince_ = getLoop()->pollReturnTime();
+    }
 
-        if (outputBuf_.readableBytes() >= highWaterMark_ && oldLen < highWaterMark_ && highWaterMarkCallback_) {
-            pOwnerIoLoop_->queueInLoop([shared_this = shared_from_this(), outBufSize = oldLen + remaining] {
-                shared_this->highWaterMarkCallback_(shared_this, outBufSize);
+    trafficCounters_.peakOutputBytes = std::max(trafficCounters_.peakOutputBytes, newLen);
+
+    if (newLen >= highWaterMark_ && oldLen < highWaterMark_) {
+        aboveHighWaterMark_ = true;
+
+        if (highWaterMarkCallback_) {
+            queueInOwnerLoop([this, newLen](const TcpConnectionPtr &conn) {
+                this->highWaterMarkCallback_(conn, newLen);
             });
         }
+    }
+
+    if (backpressurePauseBytes_ > 0 && newLen > backpressurePauseBytes_ && !readPausedByBackpressure_) {
+        MINI_MUDUO_LOG_DEBUG("TcpConnection::onOutputQueued[{}] {} bytes queued, stop reading", name(), newLen);
+
+        readPausedByBackpressure_ = true;
+        updateReadingInLoop();
+    }
 
-        if (!channel_->isWriting()) {
-            channel_->enableWriting();
+    if (channel_->isWriting()) {
+        // handleWrite() will get to it
+    } else if (autoCork_) {
+        if (!flushScheduled_) {
+            flushScheduled_ = true;
+
+            // The end of the iteration of the loop owning it now
+            getLoop()->runAtIterationEnd([shared_this = shared_from_this()] {
+                shared_this->runInOwnerLoop([pConn = shared_this.get()] {
+                    pConn->flushScheduled_ = false;
+                    pConn->flushInLoop();
+                });
+            });
         }
+    } else {
+        channel_->enableWriting();
     }
+
+    scheduleBufferTrim();
+}
+
+void TcpConnection::onOutputDrained(size_t oldLen) {
+    const size_t newLen = outputQueue_->readableBytes();
+
+    if (aboveHighWaterMark_ && newLen <= lowWaterMark_ && oldLen > lowWaterMark_) {
+        aboveHighWaterMark_ = false;
+
+        if (lowWaterMarkCallback_) {
+            queueInOwnerLoop([this, newLen](const TcpConnectionPtr &conn) {
+                this->lowWaterMarkCallback_(conn, newLen);
+            });
+        }
+    }
+
+    if (readPausedByBackpressure_ && newLen <= backpressureResumeBytes_) {
+        MINI_MUDUO_LOG_DEBUG("TcpConnection::onOutputDrained[{}] {} bytes queued, resume reading", name(), newLen);
+
+        readPausedByBackpressure_ = false;
+        updateReadingInLoop();
+    }
+}
+
+void TcpConnection::startRead() {
+    runInOwnerLoop([this] {
+        this->reading_ = true;
+        this->updateReadingInLoop();
+    });
+}
+
+void TcpConnection::stopRead() {
+    runInOwnerLoop([this] {
+        this->reading_ = false;
+        this->updateReadingInLoop();
+    });
+}
+
+void TcpConnection::updateReadingInLoop() {
+    getLoop()->assertInLoopThread();
+
+    if (state_ != State::CONNECTED && state_ != State::DISCONNECTING) {
+        return;
+    }
+
+    const bool wanted = reading_ && !readPausedByBackpressure_ && !readPausedByRelay_;
+
+    if (wanted && !channel_->isReading()) {
+        channel_->enableReading();
+    } else if (!wanted && channel_->isReading()) {
+        channel_->disableReading();
+    }
+
+    updateRegistrationInLoop();
+}
+
+void TcpConnection::updateRegistrationInLoop() {
+    if (state_ != State::CONNECTED && state_ != State::DISCONNECTING) {
+        return;
+    }
+
+    // Completions and hang ups only come with EPOLLERR and EPOLLHUP, which a removed channel never gets
+    channel_->setKeepRegistered(readPausedByRelay_ || outputQueue_->pinnedBytes() > 0);
+}
+
+void TcpConnection::flush() {
+    if (getLoop()->isInLoopThread()) {
+        flushInLoop();
+    } else {
+        runInOwnerLoop([this] {
+            this->flushInLoop();
+        });
+    }
+}
+
+void TcpConnection::flushInLoop() {
+    getLoop()->assertInLoopThread();
+
+    if (state_ == State::DISCONNECTED || channel_->isWriting() || outputQueue_->empty()) {
+        return;
+    }
+
+    writeOutputInLoop();
+
+    if (!outputQueue_->empty() && !channel_->isWriting()) {
+        channel_->enableWriting();
+    }
+}
+
+void TcpConnection::setZeroCopyThreshold(size_t thresholdBytes) {
+    if (thresholdBytes > 0 && !socket_->setZeroCopy(true)) {
+        thresholdBytes = 0;
+    }
+
+    outputQueue_->setZeroCopyThreshold(thresholdBytes);
+}
+
+size_t TcpConnection::zeroCopyPinnedBytes() const {
+    return outputQueue_->pinnedBytes();
+}
+
+size_t TcpConnection::bufferedBytes() const {
+    return inputBuf_.readableBytes() + outputQueue_->readableBytes();
+}
+
+size_t TcpConnection::reservedBytes() const {
+    return inputBuf_.internalCapacity() + outputQueue_->reservedBytes();
 }
 
 void TcpConnection::handleRead(Timestamp receiveTime) {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
+
+    // Stopped by an earlier handler of this iteration, leave it in the kernel
+    if (!channel_->isReading()) {
+        return;
+    }
+
+    if (relay_) {
+        relay_->handleRead(this);
+        return;
+    }
 
     // Why savedErrno?
     int savedErrno = 0;
-    const ssize_t n = inputBuf_.readFd(channel_->fd(), &savedErrno);
+    // Level triggered, what is left over shows up in the next poll
+    const ssize_t n = inputBuf_.readFd(channel_->fd(), &savedErrno, readBudget_);
 
     if (n > 0) {
-        messageCallback_(shared_from_this(), inputBuf_, receiveTime);
+        lastActiveTime_ = receiveTime;
+
+        trafficCounters_.bytesRead += static_cast<size_t>(n);
+        trafficCounters_.messagesRead++;
+
+        messageCallback_(self_, inputBuf_, receiveTime);
+
+        scheduleBufferTrim();
     } else if (n == 0) {
         handleClose();
     } else {
@@ -210,33 +563,120 @@ void TcpConnection::handleRead(Timestamp receiveTime) {
 }
 
 void TcpConnection::handleWrite() {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
 
     if (channel_->isWriting()) {
-        const ssize_t n = socket_ops::write(channel_->fd(), outputBuf_.peek(), outputBuf_.readableBytes());
+        if (!relay_ || !outputQueue_->empty()) {
+            writeOutputInLoop();
+        }
 
-        if (n > 0) {
-            outputBuf_.retrieve(static_cast<size_t>(n));
+        // Queued data goes first, then what the relay holds
+        if (relay_ && outputQueue_->empty()) {
+            relay_->handleWrite(this);
+        }
+    } else {
+        MINI_MUDUO_LOG_TRACE("Connection fd {} is down, no more writing", channel_->fd());
+    }
+}
+
+void TcpConnection::writeOutputInLoop() {
+    const size_t oldLen = outputQueue_->readableBytes();
 
-            if (outputBuf_.readableBytes() == 0) {
+    int savedErrno = 0;
+    const ssize_t n = outputQueue_->writeFd(channel_->fd(), &savedErrno);
+
+    trafficCounters_.writeCalls++;
+
+    updateRegistrationInLoop();
+
+    if (!outputQueue_->empty()) {
+        trafficCounters_.partialWrites++;
+    }
+
+    // 0 if a file region was dropped
+    if (n >= 0) {
+        lastActiveTime_ = getLoop()->pollReturnTime();
+        trafficCounters_.bytesWritten += static_cast<size_t>(n);
+
+        onOutputDrained(oldLen);
+
+        if (outputQueue_->empty()) {
+            // Loop time is precise enough, and free
+            if (oldLen > 0) {
+                trafficCounters_.outputQueuedTime += lastActiveTime_.timePoint() - outputQueuedSince_.timePoint();
+            }
+
+            if (channel_->isWriting()) {
                 channel_->disableWriting();
+            }
 
-                if (writeCompleteCallback_) {
-                    pOwnerIoLoop_->queueInLoop([shared_this = shared_from_this()] {
-                        shared_this->writeCompleteCallback_(shared_this);
-                    });
-                }
+            if (writeCompleteCallback_) {
+                queueInOwnerLoop([this](const TcpConnectionPtr &conn) {
+                    this->writeCompleteCallback_(conn);
+                });
+            }
 
-                if (state_ == State::DISCONNECTING) {
-                    shutdownInLoop();
-                }
+            if (state_ == State::DISCONNECTING) {
+                shutdownInLoop();
             }
-        } else {
-            MINI_MUDUO_LOG_ERROR("write()");
         }
-    } else {
-        MINI_MUDUO_LOG_TRACE("Connection fd {} is down, no more writing", channel_->fd());
+    } else if (savedErrno != EWOULDBLOCK) {
+        MINI_MUDUO_LOG_ERROR("TcpConnection::handleWrite[{}] {}", name(), strerror_tl(savedErrno));
+    }
+}
+
+void TcpConnection::scheduleBufferTrim() {
+    if (bufferTrimScheduled_ || bufferTrimIdleTimeout_ == std::chrono::milliseconds::zero() ||
+        state_ == State::DISCONNECTED) {
+        return;
+    }
+
+    // Small buffers are cheap, only bursts leave capacity worth giving back
+    if (inputBuf_.internalCapacity() <= bufferTrimThreshold_ &&
+        outputQueue_->reservedBytes() <= bufferTrimThreshold_) {
+        return;
     }
+
+    bufferTrimScheduled_ = true;
+
+    const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+        addTime(lastActiveTime_, bufferTrimIdleTimeout_).timePoint() - Timestamp::now().timePoint());
+
+    // Do not keep the connection alive only for trimming
+    getLoop()->runAfter(std::max(delay, std::chrono::milliseconds::zero()),
+                            [weak_this = std::weak_ptr<TcpConnection>(shared_from_this())] {
+                                if (auto shared_this = weak_this.lock()) {
+                                    shared_this->runInOwnerLoop([pConn = shared_this.get()] {
+                                        pConn->trimBuffersIfIdle();
+                                    });
+                                }
+                            });
+}
+
+void TcpConnection::trimBuffersIfIdle() {
+    getLoop()->assertInLoopThread();
+
+    bufferTrimScheduled_ = false;
+
+    if (state_ == State::DISCONNECTED) {
+        return;
+    }
+
+    // Active since the timer was armed, check again later
+    if (Timestamp::now() < addTime(lastActiveTime_, bufferTrimIdleTimeout_)) {
+        scheduleBufferTrim();
+        return;
+    }
+
+    if (inputBuf_.internalCapacity() > bufferTrimThreshold_) {
+        inputBuf_.shrinkToFit();
+    }
+
+    if (outputQueue_->reservedBytes() > bufferTrimThreshold_) {
+        outputQueue_->shrinkToFit();
+    }
+
+    MINI_MUDUO_LOG_TRACE("TcpConnection::trimBuffersIfIdle[{}] reserved {} bytes", name(), reservedBytes());
 }
 
 void TcpConnection::shutdown() {
@@ -246,15 +686,16 @@ void TcpConnection::shutdown() {
 
     setState(State::DISCONNECTING);
 
-    pOwnerIoLoop_->runInLoop([shared_this = shared_from_this()] {
-        shared_this->shutdownInLoop();
+    runInOwnerLoop([this] {
+        this->shutdownInLoop();
     });
 }
 
 void TcpConnection::shutdownInLoop() {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
 
-    if (!channel_->isWriting()) {
+    // Auto cork may hold data back without waiting for EPOLLOUT
+    if (!channel_->isWriting() && outputQueue_->empty()) {
         // we are not writing
         socket_->shutdownWrite();
     }
@@ -264,12 +705,14 @@ void TcpConnection::forceClose() {
     if (state_ == State::CONNECTED || state_ == State::DISCONNECTING) {
         setState(State::DISCONNECTING);
 
-        pOwnerIoLoop_->queueInLoop(std::bind(&TcpConnection::forceCloseInLoop, shared_from_this()));
+        queueInOwnerLoop([](const TcpConnectionPtr &conn) {
+            conn->forceCloseInLoop();
+        });
     }
 }
 
 void TcpConnection::forceCloseInLoop() {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
 
     if (state_ == State::CONNECTED || state_ == State::DISCONNECTING) {
         // as if we received 0 byte in handleRead();
@@ -277,12 +720,141 @@ void TcpConnection::forceCloseInLoop() {
     }
 }
 
+void TcpConnection::runInOwnerLoop(EventLoop::Functor cb) {
+    EventLoop *pLoop = getLoop();
+
+    if (pLoop->isInLoopThread()) {
+        cb();
+        return;
+    }
+
+    // Holds the only reference, cb borrows this. Migrated while it was queued, it follows the connection
+    pLoop->queueInLoop([shared_this = shared_from_this(), cb = std::move(cb)]() mutable {
+        shared_this->runInOwnerLoop(std::move(cb));
+    });
+}
+
+void TcpConnection::queueInOwnerLoop(ConnectionCallback cb) {
+    // Forwarded after a migration, it may run once the new loop let go of self_
+    getLoop()->queueInLoop([shared_this = shared_from_this(), cb = std::move(cb)]() mutable {
+        if (shared_this->getLoop()->isInLoopThread()) {
+            cb(shared_this);
+        } else {
+            shared_this->queueInOwnerLoop(std::move(cb));
+        }
+    });
+}
+
+void TcpConnection::migrateTo(EventLoop *pNewLoop) {
+    assert(pNewLoop);
+
+    // Queued even in loop, the caller may be in the middle of handling an event of this
+    queueInOwnerLoop([pNewLoop](const TcpConnectionPtr &conn) {
+        conn->migrateInLoop(pNewLoop);
+    });
+}
+
+void TcpConnection::migrateInLoop(EventLoop *pNewLoop) {
+    EventLoop *pOldLoop = getLoop();
+
+    pOldLoop->assertInLoopThread();
+
+    if (pNewLoop == pOldLoop || state_ != State::CONNECTED) {
+        return;
+    }
+
+    // Splicing pipes and the peer connection are bound to this loop
+    if (!canMigrate()) {
+        MINI_MUDUO_LOG_WARN("TcpConnection::migrateInLoop[{}] can not be migrated", name());
+        return;
+    }
+
+    // The owner moves its bookkeeping, or refuses a loop it does not know
+    if (!migrateCallback_(self_, pNewLoop)) {
+        return;
+    }
+
+    const bool wasReading = channel_->isReading();
+    const bool wasWriting = channel_->isWriting();
+
+    channel_->disableAll();
+    channel_->remove();
+    channel_->setLoop(pNewLoop);
+
+    // Closures queued from now on land in the new loop, those already queued follow
+    pOwnerIoLoop_.store(pNewLoop, std::memory_order_release);
+
+    MINI_MUDUO_LOG_DEBUG("TcpConnection::migrateInLoop[{}] fd = {}", name(), channel_->fd());
+
+    // Level triggered, whatever arrived meanwhile is reported by the new poller
+    // A close forwarded meanwhile may have come first
+    pNewLoop->queueInLoop([shared_this = self_, wasReading, wasWriting] {
+        Channel *pChannel = shared_this->channel_.get();
+
+        if (shared_this->state_ == State::DISCONNECTED) {
+            return;
+        }
+
+        if (wasReading && !pChannel->isReading()) {
+            pChannel->enableReading();
+        }
+
+        if (wasWriting && !pChannel->isWriting()) {
+            pChannel->enableWriting();
+        }
+
+        // Registered even without events, onConnectionDestroyed() removes it
+        if (!pChannel->isReading() && !pChannel->isWriting()) {
+            pChannel->disableAll();
+        }
+    });
+}
+
 void TcpConnection::setTcpNoDelay(bool on) {
     socket_->setTcpNoDelay(on);
 }
 
+void TcpConnection::setTcpNotSentLowat(size_t bytes) {
+    socket_->setTcpNotSentLowat(bytes);
+}
+
+TrafficCounters TcpConnection::trafficCounters() const {
+    TrafficCounters counters = trafficCounters_;
+
+    // Only added once the queue drains, a stalled one would look idle
+    if (!outputQueue_->empty()) {
+        counters.outputQueuedTime += Timestamp::now().timePoint() - outputQueuedSince_.timePoint();
+    }
+
+    return counters;
+}
+
+bool TcpConnection::sampleTcpInfo() {
+    getLoop()->assertInLoopThread();
+
+    struct tcp_info info;
+
+    if (!socket_->getTcpInfo(&info)) {
+        MINI_MUDUO_LOG_ERROR("TcpConnection::sampleTcpInfo[{}] {}", name(), strerror_tl(errno));
+        return false;
+    }
+
+    tcpInfo_.sampleTime = Timestamp::now();
+    tcpInfo_.rtt = std::chrono::microseconds(info.tcpi_rtt);
+    tcpInfo_.rttVar = std::chrono::microseconds(info.tcpi_rttvar);
+    tcpInfo_.congestionWindow = info.tcpi_snd_cwnd;
+    tcpInfo_.retransmits = info.tcpi_total_retrans;
+    tcpInfo_.unackedSegments = info.tcpi_unacked;
+
+    // Not in the TCP_INFO of glibc
+    const int notSent = socket_->getNotSentBytes();
+    tcpInfo_.notSentBytes = notSent > 0 ? static_cast<uint32_t>(notSent) : 0;
+
+    return true;
+}
+
 void TcpConnection::handleClose() {
-    pOwnerIoLoop_->assertInLoopThread();
+    getLoop()->assertInLoopThread();
 
     MINI_MUDUO_LOG_TRACE("fd = {}, state = {}", channel_->fd(), static_cast<int>(state_));
 
@@ -291,21 +863,35 @@ void TcpConnection::handleClose() {
     // we don't close fd, leave it to dtor, so we can find leaks easily.
     setState(State::DISCONNECTED);
 
+    // In this order, updating a removed channel would add it again
     channel_->disableAll();
+    channel_->setKeepRegistered(false);
 
-    TcpConnectionPtr guardThis(shared_from_this());
+    if (relay_) {
+        relay_->handleClose(this);
+    }
 
-    connectionCallback_(guardThis);
+    // self_ guards this until onConnectionDestroyed()
+    connectionCallback_(self_);
 
     // must be the last line
-    // Call TcpServer::removeConnection() or TcpClient::removeConnection() with guardThis
-    closeCallback_(guardThis);
+    // Call TcpServer::removeConnection() or TcpClient::removeConnection() with self_
+    closeCallback_(self_);
 }
 
 void TcpConnection::handleError() {
+    // MSG_ZEROCOPY completions wake us up through EPOLLERR as well
+    if (outputQueue_->pinnedBytes() > 0) {
+        outputQueue_->handleZeroCopyCompletions(channel_->fd());
+
+        updateRegistrationInLoop();
+    }
+
     const int err = socket_ops::getSocketError(channel_->fd());
 
-    MINI_MUDUO_LOG_ERROR("Socket {} {}", name_, strerror_tl(err));
+    if (err != 0) {
+        MINI_MUDUO_LOG_ERROR("Socket {} {}", name(), strerror_tl(err));
+    }
 }
 
 }  // namespace mini_muduo
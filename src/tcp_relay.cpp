@@ -0,0 +1,232 @@
+#include <mini_muduo/tcp_relay.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+
+#include "output_queue.h"
+
+#include <mini_muduo/channel.h>
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/log.h>
+#include <mini_muduo/socket_ops.h>
+#include <mini_muduo/tcp_connection.h>
+
+namespace mini_muduo {
+
+TcpRelay::TcpRelay(const TcpConnectionPtr &first, const TcpConnectionPtr &second) {
+    directions_[0].pFrom = first.get();
+    directions_[0].from = first;
+    directions_[0].to = second;
+
+    directions_[1].pFrom = second.get();
+    directions_[1].from = second;
+    directions_[1].to = first;
+}
+
+TcpRelay::~TcpRelay() {
+    for (auto &dir : directions_) {
+        for (int fd : dir.pipeFds) {
+            if (fd >= 0) {
+                socket_ops::close(fd);
+            }
+        }
+    }
+}
+
+bool TcpRelay::start(const TcpConnectionPtr &first, const TcpConnectionPtr &second) {
+    EventLoop *pLoop = first->getLoop();
+
+    assert(second->getLoop() == pLoop);
+    pLoop->assertInLoopThread();
+
+    if (!first->connected() || !second->connected()) {
+        return false;
+    }
+
+    // Private constructor, std::make_shared() can not reach it
+    const std::shared_ptr<TcpRelay> relay(new TcpRelay(first, second));
+
+    if (!relay->openPipes()) {
+        return false;
+    }
+
+    first->relay_ = relay;
+    second->relay_ = relay;
+
+    for (auto &dir : relay->directions_) {
+        const auto from = dir.from.lock();
+        const auto to = dir.to.lock();
+
+        // Read before the relay started, ahead of everything spliced
+        if (from->inputBuf_.readableBytes() > 0) {
+            to->sendInLoop(from->inputBuf_.toStringView());
+            from->inputBuf_.retrieveAll();
+        }
+
+        from->updateReadingInLoop();
+    }
+
+    return true;
+}
+
+bool TcpRelay::openPipes() {
+    for (auto &dir : directions_) {
+        if (::pipe2(dir.pipeFds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            MINI_MUDUO_LOG_ERROR("TcpRelay pipe2() {}", strerror_tl(errno));
+            return false;
+        }
+
+        // Fewer wake ups with a larger pipe, the default one works as well
+        (void)::fcntl(dir.pipeFds[1], F_SETPIPE_SZ, kPipeSize);
+
+        dir.capacity = static_cast<size_t>(::fcntl(dir.pipeFds[1], F_GETPIPE_SZ));
+    }
+
+    return true;
+}
+
+void TcpRelay::handleRead(TcpConnection *pConn) {
+    Direction &dir = directionFrom(pConn);
+
+    if (dir.pipedBytes >= dir.capacity) {
+        setSourcePaused(dir, true);
+        return;
+    }
+
+    const ssize_t n = socket_ops::splice(pConn->channel_->fd(), dir.pipeFds[1], dir.capacity - dir.pipedBytes);
+
+    if (n > 0) {
+        dir.pipedBytes += static_cast<size_t>(n);
+        pConn->trafficCounters_.bytesRead += static_cast<size_t>(n);
+
+        pump(dir);
+
+        if (dir.pipedBytes >= dir.capacity) {
+            setSourcePaused(dir, true);
+        }
+    } else if (n == 0) {
+        dir.eof = true;
+
+        setSourcePaused(dir, true);
+
+        // Shuts down the destination once the pipe is drained
+        pump(dir);
+    } else if (errno == EAGAIN) {
+        // Pipe slots are taken by small packets before its bytes are
+        if (dir.pipedBytes > 0) {
+            setSourcePaused(dir, true);
+        }
+    } else {
+        pConn->handleError();
+    }
+}
+
+void TcpRelay::handleWrite(TcpConnection *pConn) {
+    pump(directionTo(pConn));
+}
+
+void TcpRelay::handleClose(TcpConnection *pConn) {
+    Direction &out = directionFrom(pConn);
+    const Direction &in = directionTo(pConn);
+
+    out.eof = true;
+
+    const auto peer = out.to.lock();
+
+    if (!peer || peer->disconnected()) {
+        return;
+    }
+
+    // The peer still has data for us, which can not be delivered any more
+    if (!in.eof || in.pipedBytes > 0) {
+        peer->forceClose();
+        return;
+    }
+
+    pump(out);
+}
+
+void TcpRelay::pump(Direction &dir) {
+    const auto to = dir.to.lock();
+
+    if (!to || to->disconnected()) {
+        return;
+    }
+
+    Channel *pChannel = to->channel_.get();
+
+    // Queued data goes first, handleWrite() comes back once it is written
+    if (!to->outputQueue_->empty()) {
+        if (!pChannel->isWriting()) {
+            pChannel->enableWriting();
+        }
+
+        return;
+    }
+
+    if (dir.pipedBytes > 0) {
+        const ssize_t n = socket_ops::splice(dir.pipeFds[0], pChannel->fd(), dir.pipedBytes);
+
+        to->trafficCounters_.writeCalls++;
+
+        if (n > 0) {
+            dir.pipedBytes -= static_cast<size_t>(n);
+            to->trafficCounters_.bytesWritten += static_cast<size_t>(n);
+
+            if (!dir.eof) {
+                setSourcePaused(dir, false);
+            }
+        } else if (n < 0 && errno != EAGAIN) {
+            // The connection learns about it from epoll as well
+            MINI_MUDUO_LOG_ERROR("TcpRelay splice() to {} {}", to->name(), strerror_tl(errno));
+            return;
+        }
+    }
+
+    if (dir.pipedBytes > 0) {
+        if (!pChannel->isWriting()) {
+            pChannel->enableWriting();
+        }
+    } else {
+        if (pChannel->isWriting()) {
+            pChannel->disableWriting();
+        }
+
+        if (dir.eof) {
+            to->shutdown();
+
+            closeIfFinished();
+        }
+    }
+}
+
+void TcpRelay::closeIfFinished() {
+    for (const auto &dir : directions_) {
+        const auto to = dir.to.lock();
+
+        if (!dir.eof || dir.pipedBytes > 0 || (to && !to->outputQueue_->empty())) {
+            return;
+        }
+    }
+
+    // Both sides half closed and everything delivered, no event would close them
+    for (const auto &dir : directions_) {
+        if (const auto from = dir.from.lock()) {
+            from->forceClose();
+        }
+    }
+}
+
+void TcpRelay::setSourcePaused(Direction &dir, bool paused) {
+    const auto from = dir.from.lock();
+
+    if (from && from->readPausedByRelay_ != paused) {
+        from->readPausedByRelay_ = paused;
+        from->updateReadingInLoop();
+    }
+}
+
+}  // namespace mini_muduo
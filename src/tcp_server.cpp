@@ -1,9 +1,13 @@
 #include <mini_muduo/tcp_server.h>
 
+#include <algorithm>
 #include <cassert>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "acceptor.h"
 
@@ -12,98 +16,781 @@
 
 namespace mini_muduo {
 
+TcpServer::LoopShard::LoopShard(EventLoop *pShardLoop)
+    : pLoop(pShardLoop) {}
+
+TcpServer::LoopShard::~LoopShard() = default;
+
 TcpServer::TcpServer(EventLoop *pLoop, const InetAddress &listenAddr, std::string name, int nThreads, Option option)
+    : TcpServer(pLoop, listenAddr, std::move(name), nThreads, option, {}) {}
+
+TcpServer::TcpServer(EventLoop *pLoop, std::vector<int> listenFds, std::string name, int nThreads, Option option)
+    : TcpServer(pLoop,
+                InetAddress(socket_ops::getLocalAddr(listenFds.at(0))),
+                std::move(name),
+                nThreads,
+                option,
+                listenFds) {}
+
+TcpServer::TcpServer(EventLoop *pLoop,
+                     const InetAddress &listenAddr,
+                     std::string name,
+                     int nThreads,
+                     Option option,
+                     const std::vector<int> &inheritedListenFds)
     : pOwnerMainLoop_(pLoop)
     , name_(std::move(name))
     , ipPort_(listenAddr.toIpPort())
+    , connNamePrefix_(std::make_shared<const std::string>(name_ + "-" + ipPort_ + "#"))
     , threadPool_(pLoop, nThreads)
-    , acceptor_(std::make_unique<Acceptor>(pOwnerMainLoop_, listenAddr, option == Option::REUSE_PORT)) {
-    acceptor_->setNewConnectionCallback([this](int sockFd, const InetAddress &peerAddr) {
-        this->onNewConnection(sockFd, peerAddr);
-    });
+    , listenAddr_(listenAddr)
+    , acceptor_(option == Option::REUSE_PORT_PER_LOOP ? nullptr
+                : !inheritedListenFds.empty()
+                    ? std::make_unique<Acceptor>(pOwnerMainLoop_, inheritedListenFds[0])
+                    : std::make_unique<Acceptor>(pOwnerMainLoop_, listenAddr, option == Option::REUSE_PORT)) {
+    // Unix domain sockets have no SO_REUSEPORT groups
+    assert(option != Option::REUSE_PORT_PER_LOOP || listenAddr.family() != AF_UNIX);
+
+    if (option == Option::REUSE_PORT_PER_LOOP) {
+        // Loops are not there yet
+        inheritedListenFds_ = inheritedListenFds;
+    } else {
+        for (size_t i = 1; i < inheritedListenFds.size(); i++) {
+            MINI_MUDUO_LOG_WARN("TcpServer [{}] - surplus listening socket {} closed", name_, inheritedListenFds[i]);
+            socket_ops::close(inheritedListenFds[i]);
+        }
+    }
+
+    if (acceptor_) {
+        acceptor_->setNewConnectionsCallback([this](const NewConnections &accepted) {
+            this->onNewConnections(accepted);
+        });
+    }
 }
 
 TcpServer::~TcpServer() {
     pOwnerMainLoop_->assertInLoopThread();
 
-    for (auto &item : connections_) {
-        TcpConnectionPtr conn(item.second);
+    if (tcpInfoSampleInterval_ > std::chrono::milliseconds::zero() && listenAddr_.family() != AF_UNIX) {
+        pOwnerMainLoop_->cancel(tcpInfoTimer_);
+    }
 
-        item.second.reset();
+    if (rebalanceInterval_ > std::chrono::milliseconds::zero() && shards_.size() > 1) {
+        pOwnerMainLoop_->cancel(rebalanceTimer_);
+    }
 
-        conn->getLoop()->runInLoop([conn] {
-            conn->onConnectionDestroyed();
+    if (mainAcceptPause_.paused) {
+        pOwnerMainLoop_->cancel(mainAcceptPause_.resumeTimer);
+    }
+
+    // Never adopted, start() was not called
+    for (int fd : inheritedListenFds_) {
+        socket_ops::close(fd);
+    }
+
+    std::vector<std::future<void>> acceptorsClosed;
+
+    // Also waits for loops without an acceptor, handOver() may be resetting theirs
+    for (const auto &shard : shards_) {
+        auto closed = std::make_shared<std::promise<void>>();
+        acceptorsClosed.push_back(closed->get_future());
+
+        shard->pLoop->runInLoop([shard, closed] {
+            if (shard->acceptPause.paused) {
+                shard->pLoop->cancel(shard->acceptPause.resumeTimer);
+            }
+
+            shard->acceptor.reset();
+            shard->closed = true;
+            closed->set_value();
+
+            for (auto &item : shard->connections) {
+                item.second->onConnectionDestroyed();
+            }
+
+            shard->connections.clear();
         });
     }
+
+    // A per loop acceptor calls back into this object until it is closed
+    for (auto &closed : acceptorsClosed) {
+        closed.wait();
+    }
 }
 
 void TcpServer::start() {
-    assert(!acceptor_->listening());
+    assert(!acceptor_ || !acceptor_->listening());
 
     std::call_once(startOnce_, [this] {
         this->threadPool_.start();
 
+        for (EventLoop *pIoLoop : this->threadPool_.getAllLoops()) {
+            this->shards_.push_back(std::make_shared<LoopShard>(pIoLoop));
+            this->shards_.back()->nextConnId = this->shards_.size();
+        }
+
         this->pOwnerMainLoop_->runInLoop([this] {
-            this->acceptor_->listen();
+            if (this->acceptor_) {
+                if (this->maxAcceptsPerRead_ > 0) {
+                    this->acceptor_->setMaxAcceptsPerRead(this->maxAcceptsPerRead_);
+                }
+
+                this->acceptor_->listen();
+            } else {
+                this->listenPerLoop();
+            }
+
+            if (this->tcpInfoSampleInterval_ > std::chrono::milliseconds::zero() &&
+                this->listenAddr_.family() != AF_UNIX) {
+                this->tcpInfoTimer_ = this->pOwnerMainLoop_->runEvery(this->tcpInfoSampleInterval_, [this] {
+                    this->sampleTcpInfo();
+                });
+            }
+
+            if (this->rebalanceInterval_ > std::chrono::milliseconds::zero() && this->shards_.size() > 1) {
+                this->rebalanceTimer_ = this->pOwnerMainLoop_->runEvery(this->rebalanceInterval_, [this] {
+                    this->rebalance();
+                });
+            }
         });
     });
 }
 
-void TcpServer::onNewConnection(int sockFd, const InetAddress &peerAddr) {
+void TcpServer::listenPerLoop() {
     pOwnerMainLoop_->assertInLoopThread();
 
-    char buf[64];
-    snprintf(buf, sizeof(buf), "-%s#%d", ipPort_.c_str(), nextConnId_++);
+    std::vector<std::future<void>> listening;
 
-    std::string connName = name_ + buf;
+    // CPU a loop is pinned to, indexed as the listeners joined the reuseport group
+    std::vector<int> cpuOfListener(shards_.size(), -1);
 
-    MINI_MUDUO_LOG_INFO(
-        "TcpServer::newConnection [{}] - new connection [{}] from {}", name_, connName, peerAddr.toIpPort());
+    for (size_t i = 0; i < shards_.size(); i++) {
+        const LoopShardPtr &shard = shards_[i];
+        LoopShard *pShard = shard.get();
 
-    InetAddress localAddr(socket_ops::getLocalAddr(sockFd));
+        // Bound here, so that a taken port fails in the caller's thread
+        pShard->acceptor = i < inheritedListenFds_.size()
+                               ? std::make_unique<Acceptor>(pShard->pLoop, inheritedListenFds_[i])
+                               : std::make_unique<Acceptor>(pShard->pLoop, listenAddr_, true);
+        pShard->acceptor->setNewConnectionsCallback([this, pShard](const NewConnections &accepted) {
+            this->onNewConnectionsInLoop(pShard, accepted);
+        });
 
-    // FIXME poll with zero timeout to double confirm the new connection
-    EventLoop *pIoLoop = threadPool_.getNextLoop();
+        if (maxAcceptsPerRead_ > 0) {
+            pShard->acceptor->setMaxAcceptsPerRead(maxAcceptsPerRead_);
+        }
 
-    const auto conn = std::make_shared<TcpConnection>(pIoLoop, connName, sockFd, localAddr, peerAddr);
+        if (const std::vector<int> &cpus = threadPool_.cpusOf(pShard->pLoop); cpus.size() == 1) {
+            pShard->acceptor->setIncomingCpu(cpus[0]);
+            cpuOfListener[i] = cpus[0];
+        }
 
-    connections_[connName] = conn;
+        auto listened = std::make_shared<std::promise<void>>();
+        listening.push_back(listened->get_future());
+
+        pShard->pLoop->runInLoop([shard, listened] {
+            shard->acceptor->listen();
+            listened->set_value();
+        });
+
+        // A listener joins the group on listen(), the program indexes them in shard order
+        if (reusePortCpuSteering_) {
+            listening.back().wait();
+        }
+    }
+
+    if (reusePortCpuSteering_ && !shards_.empty()) {
+        if (std::all_of(cpuOfListener.begin(), cpuOfListener.end(), [](int cpu) {
+                return cpu < 0;
+            })) {
+            MINI_MUDUO_LOG_WARN("TcpServer [{}] - no loop pinned to a single CPU, nothing to steer", name_);
+        } else if (shards_[0]->acceptor->setReusePortCpuSteering(cpuOfListener)) {
+            MINI_MUDUO_LOG_INFO("TcpServer [{}] - connections steered to the listener of their CPU", name_);
+        }
+    }
+
+    for (size_t i = shards_.size(); i < inheritedListenFds_.size(); i++) {
+        MINI_MUDUO_LOG_WARN("TcpServer [{}] - surplus listening socket {} closed", name_, inheritedListenFds_[i]);
+        socket_ops::close(inheritedListenFds_[i]);
+    }
+
+    inheritedListenFds_.clear();
+
+    // Clients may connect as soon as start() returns
+    for (auto &listened : listening) {
+        listened.wait();
+    }
+}
+
+bool TcpServer::handOver(int unixFd, DrainedCallback cb) {
+    pOwnerMainLoop_->assertInLoopThread();
+    assert(!shards_.empty());
+
+    if (draining()) {
+        return false;
+    }
+
+    std::vector<int> listenFds;
+
+    if (acceptor_) {
+        listenFds.push_back(acceptor_->fd());
+    } else {
+        // Created in this loop by listenPerLoop(), only reset by handOver()
+        for (const auto &shard : shards_) {
+            listenFds.push_back(shard->acceptor->fd());
+        }
+    }
+
+    if (!socket_ops::sendFds(unixFd, listenFds)) {
+        MINI_MUDUO_LOG_ERROR("TcpServer::handOver [{}] - {}", name_, strerror_tl(errno));
+        return false;
+    }
+
+    MINI_MUDUO_LOG_INFO("TcpServer::handOver [{}] - {} listening sockets handed over, draining {} connections",
+                        name_,
+                        listenFds.size(),
+                        connectionCount());
+
+    drainedCb_ = std::move(cb);
+    draining_.store(true, std::memory_order_release);
+
+    // Closes our descriptors only, the successor keeps the sockets and their backlogs
+    if (acceptor_) {
+        if (mainAcceptPause_.paused) {
+            pOwnerMainLoop_->cancel(mainAcceptPause_.resumeTimer);
+            mainAcceptPause_.paused = false;
+        }
+
+        acceptor_.reset();
+    } else {
+        std::vector<std::future<void>> acceptorsClosed;
+
+        for (const auto &shard : shards_) {
+            auto closed = std::make_shared<std::promise<void>>();
+            acceptorsClosed.push_back(closed->get_future());
+
+            shard->pLoop->runInLoop([shard, closed] {
+                if (shard->acceptPause.paused) {
+                    shard->pLoop->cancel(shard->acceptPause.resumeTimer);
+                    shard->acceptPause.paused = false;
+                }
+
+                shard->acceptor.reset();
+                closed->set_value();
+            });
+        }
+
+        // The drained callback may destroy this server, not before every acceptor is closed
+        for (auto &closed : acceptorsClosed) {
+            closed.wait();
+        }
+    }
+
+    callDrainedCallbackIfDrained();
+
+    return true;
+}
+
+void TcpServer::callDrainedCallbackIfDrained() {
+    pOwnerMainLoop_->assertInLoopThread();
+
+    if (!drainedCb_ || connectionCount() > 0) {
+        return;
+    }
+
+    MINI_MUDUO_LOG_INFO("TcpServer [{}] - drained", name_);
+
+    // Called once, it may well destroy this server
+    const DrainedCallback cb = std::move(drainedCb_);
+    drainedCb_ = nullptr;
+
+    cb();
+}
+
+size_t TcpServer::connectionCount() const {
+    size_t total = 0;
+
+    for (EventLoop *pLoop : threadPool_.getAllLoops()) {
+        total += threadPool_.connectionCount(pLoop);
+    }
+
+    return total;
+}
+
+void TcpServer::onNewConnections(const NewConnections &accepted) {
+    pOwnerMainLoop_->assertInLoopThread();
+
+    acceptBatches_.fetch_add(1, std::memory_order_relaxed);
+
+    // Judged before this batch adds to the load, the next one waits
+    pauseAcceptIfOverloaded(nullptr);
+
+    // One post per IO loop for the whole batch
+    std::vector<std::vector<TcpConnectionPtr>> batches(shards_.size());
+
+    for (const auto &[sockFd, peerAddr] : accepted) {
+        // FIXME poll with zero timeout to double confirm the new connection
+        EventLoop *pIoLoop = threadPool_.selectLoop(peerAddr);
+
+        if (!admit(pIoLoop)) {
+            reject(sockFd);
+            continue;
+        }
+
+        const auto it = std::find_if(shards_.begin(), shards_.end(), [pIoLoop](const LoopShardPtr &shard) {
+            return shard->pLoop == pIoLoop;
+        });
+        assert(it != shards_.end());
+
+        batches[static_cast<size_t>(it - shards_.begin())].push_back(newConnection(it->get(), sockFd, peerAddr));
+    }
+
+    for (size_t i = 0; i < shards_.size(); i++) {
+        if (batches[i].empty()) {
+            continue;
+        }
+
+        shards_[i]->pLoop->runInLoop([shard = shards_[i], conns = std::move(batches[i])] {
+            for (const auto &conn : conns) {
+                shard->connections[conn->id()] = conn;
+                conn->onConnectionEstablished();
+            }
+        });
+    }
+}
+
+void TcpServer::onNewConnectionsInLoop(LoopShard *pShard, const NewConnections &accepted) {
+    pShard->pLoop->assertInLoopThread();
+
+    acceptBatches_.fetch_add(1, std::memory_order_relaxed);
+
+    pauseAcceptIfOverloaded(pShard);
+
+    for (const auto &[sockFd, peerAddr] : accepted) {
+        if (!admit(pShard->pLoop)) {
+            reject(sockFd);
+            continue;
+        }
+
+        const TcpConnectionPtr conn = newConnection(pShard, sockFd, peerAddr);
+
+        pShard->connections[conn->id()] = conn;
+        conn->onConnectionEstablished();
+    }
+}
+
+bool TcpServer::admit(EventLoop *pIoLoop) const {
+    const AdmissionLimits &limits = admissionLimits_;
+
+    if (limits.maxConnectionsPerLoop > 0 && threadPool_.connectionCount(pIoLoop) >= limits.maxConnectionsPerLoop) {
+        return false;
+    }
+
+    if (limits.maxConnections > 0 && connectionCount() >= limits.maxConnections) {
+        return false;
+    }
+
+    return true;
+}
+
+void TcpServer::reject(int sockFd) {
+    rejectedConnections_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::string &response = admissionLimits_.rejectResponse;
+
+    if (!response.empty()) {
+        // The send buffer of a new socket is empty, short responses fit
+        (void)socket_ops::write(sockFd, response.data(), response.size());
+        socket_ops::shutdownWrite(sockFd);
+    } else {
+        // Closing with a zero linger time resets the connection
+        const struct linger lg = {1, 0};
+        (void)::setsockopt(sockFd, SOL_SOCKET, SO_LINGER, &lg, static_cast<socklen_t>(sizeof lg));
+    }
+
+    socket_ops::close(sockFd);
+}
+
+bool TcpServer::overloaded(const LoopShard *pShard) const {
+    const AdmissionLimits &limits = admissionLimits_;
+
+    const auto loopOverloaded = [&limits](const EventLoop *pLoop) {
+        const bool lagging =
+            limits.maxLoopLag > std::chrono::microseconds::zero() && pLoop->lastIterationTime() > limits.maxLoopLag;
+        const bool queueing =
+            limits.maxPendingFunctors > 0 && pLoop->pendingFunctorCount() > limits.maxPendingFunctors;
+
+        return lagging || queueing;
+    };
+
+    if (pShard) {
+        return loopOverloaded(pShard->pLoop);
+    }
+
+    // The main acceptor still has somewhere to put connections
+    return std::all_of(shards_.begin(), shards_.end(), [&loopOverloaded](const LoopShardPtr &shard) {
+        return loopOverloaded(shard->pLoop);
+    });
+}
+
+void TcpServer::pauseAcceptIfOverloaded(LoopShard *pShard) {
+    if (!overloaded(pShard)) {
+        return;
+    }
+
+    (pShard ? pShard->acceptor.get() : acceptor_.get())->pause();
+    acceptPauses_.fetch_add(1, std::memory_order_relaxed);
+
+    MINI_MUDUO_LOG_WARN("TcpServer [{}] - loops overloaded, accepting paused", name_);
+
+    scheduleAcceptResumeCheck(pShard);
+}
+
+void TcpServer::scheduleAcceptResumeCheck(LoopShard *pShard) {
+    EventLoop *pLoop = pShard ? pShard->pLoop : pOwnerMainLoop_;
+    AcceptPause &pause = pShard ? pShard->acceptPause : mainAcceptPause_;
+
+    pause.paused = true;
+    pause.resumeTimer = pLoop->runAfter(kAcceptResumeCheckInterval, [this, pShard] {
+        this->resumeAcceptIfRecovered(pShard);
+    });
+}
+
+void TcpServer::resumeAcceptIfRecovered(LoopShard *pShard) {
+    if (overloaded(pShard)) {
+        scheduleAcceptResumeCheck(pShard);
+        return;
+    }
+
+    MINI_MUDUO_LOG_INFO("TcpServer [{}] - accepting resumed", name_);
+
+    (pShard ? pShard->acceptPause : mainAcceptPause_).paused = false;
+    (pShard ? pShard->acceptor.get() : acceptor_.get())->resume();
+}
+
+TcpConnectionPtr TcpServer::newConnection(LoopShard *pShard, int sockFd, const InetAddress &peerAddr) {
+    const uint64_t connId = pShard->nextConnId;
+    pShard->nextConnId += shards_.size();
+
+    // Names and addresses are only formatted if they are logged
+    if (spdlog::should_log(spdlog::level::info)) {
+        MINI_MUDUO_LOG_INFO("TcpServer::newConnection [{}] - new connection [{}{}] from {}",
+                            name_,
+                            *connNamePrefix_,
+                            connId,
+                            peerAddr.toIpPort());
+    }
+
+    InetAddress localAddr(socket_ops::getLocalAddr(sockFd));
+
+    const auto conn =
+        std::make_shared<TcpConnection>(pShard->pLoop, connId, connNamePrefix_, sockFd, localAddr, peerAddr);
+
+    threadPool_.connectionOpened(pShard->pLoop);
 
     conn->setConnectionCallback(connectionCb_);
     conn->setMessageCallback(messageCb_);
     conn->setWriteCompleteCallback(writeCompleteCb_);
+    conn->setBufferTrimPolicy(bufferTrimIdleTimeout_, bufferTrimThreshold_);
+    conn->setReadBudget(readBudget_);
+    conn->setAutoCork(autoCork_);
+
+    if (tcpNotSentLowat_ > 0 && listenAddr_.family() != AF_UNIX) {
+        conn->setTcpNotSentLowat(tcpNotSentLowat_);
+    }
+
+    if (zeroCopyThreshold_ > 0) {
+        conn->setZeroCopyThreshold(zeroCopyThreshold_);
+    }
+
+    bindToShard(pShard, conn);
 
+    return conn;
+}
+
+void TcpServer::bindToShard(LoopShard *pShard, const TcpConnectionPtr &conn) {
     // DO NOT capture conn to avoid mutual reference TcpConnection class
-    conn->setCloseCallback([this](const TcpConnectionPtr &argConn) {
-        this->removeConnection(argConn);
+    conn->setCloseCallback([this, pShard](const TcpConnectionPtr &argConn) {
+        this->removeConnectionInLoop(pShard, argConn);
     });  // FIXME: unsafe. Why???
 
-    pIoLoop->runInLoop([conn] {
-        conn->onConnectionEstablished();
+    conn->setMigrateCallback([this, pShard](const TcpConnectionPtr &argConn, EventLoop *pNewLoop) {
+        return this->migrateConnectionInLoop(pShard, argConn, pNewLoop);
     });
 }
 
-void TcpServer::removeConnection(const TcpConnectionPtr &conn) {
-    // FIXME: unsafe. Why???
-    pOwnerMainLoop_->runInLoop([this, conn] {
-        this->removeConnectionInLoop(conn);
+bool TcpServer::migrateConnectionInLoop(LoopShard *pShard, const TcpConnectionPtr &conn, EventLoop *pNewLoop) {
+    pShard->pLoop->assertInLoopThread();
+
+    const auto it = std::find_if(shards_.begin(), shards_.end(), [pNewLoop](const LoopShardPtr &shard) {
+        return shard->pLoop == pNewLoop;
     });
+
+    if (it == shards_.end()) {
+        MINI_MUDUO_LOG_WARN("TcpServer::migrateConnectionInLoop [{}] - not a loop of this server", name_);
+        return false;
+    }
+
+    const LoopShardPtr &newShard = *it;
+
+    const size_t n = pShard->connections.erase(conn->id());
+    (void)n;
+    assert(n == 1);
+
+    pShard->rebalanceTraffic.erase(conn->id());
+
+    threadPool_.connectionClosed(pShard->pLoop);
+    threadPool_.connectionOpened(pNewLoop);
+
+    bindToShard(newShard.get(), conn);
+
+    migratedConnections_.fetch_add(1, std::memory_order_relaxed);
+
+    // Queued before the connection is attached there, so it is found when it closes
+    pNewLoop->queueInLoop([newShard, conn] {
+        // The server went away while it was moving
+        if (newShard->closed) {
+            conn->onConnectionDestroyed();
+            return;
+        }
+
+        newShard->connections[conn->id()] = conn;
+    });
+
+    return true;
 }
 
-void TcpServer::removeConnectionInLoop(const TcpConnectionPtr &conn) {
+void TcpServer::rebalance() {
     pOwnerMainLoop_->assertInLoopThread();
 
-    MINI_MUDUO_LOG_INFO("TcpServer::removeConnectionInLoop [{}] - connection {}", name_, conn->name());
+    std::vector<std::chrono::nanoseconds> busyTimes(shards_.size());
+
+    for (size_t i = 0; i < shards_.size(); i++) {
+        busyTimes[i] = shards_[i]->pLoop->busyTime();
+    }
+
+    // First sample, nothing to compare with yet
+    if (rebalanceBusyTimes_.empty()) {
+        rebalanceBusyTimes_ = std::move(busyTimes);
+        return;
+    }
+
+    std::vector<std::chrono::nanoseconds> recent(shards_.size());
+
+    for (size_t i = 0; i < shards_.size(); i++) {
+        recent[i] = busyTimes[i] - rebalanceBusyTimes_[i];
+    }
+
+    rebalanceBusyTimes_ = std::move(busyTimes);
+
+    if (draining()) {
+        return;
+    }
+
+    const auto [minIt, maxIt] = std::minmax_element(recent.begin(), recent.end());
+    const std::chrono::nanoseconds gap = *maxIt - *minIt;
+
+    if (gap.count() <= 0 ||
+        static_cast<double>(gap.count()) <
+            rebalanceMinImbalance_ * static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(rebalanceInterval_).count())) {
+        return;
+    }
+
+    const LoopShardPtr &busiest = shards_[static_cast<size_t>(maxIt - recent.begin())];
+    EventLoop *pLeastBusyLoop = shards_[static_cast<size_t>(minIt - recent.begin())]->pLoop;
+
+    busiest->pLoop->runInLoop([this, busiest, pLeastBusyLoop, busyTime = *maxIt, gap] {
+        this->migrateHottestInLoop(busiest.get(), pLeastBusyLoop, busyTime, gap);
+    });
+}
+
+void TcpServer::migrateHottestInLoop(LoopShard *pShard,
+                                     EventLoop *pNewLoop,
+                                     std::chrono::nanoseconds busyTime,
+                                     std::chrono::nanoseconds gap) {
+    pShard->pLoop->assertInLoopThread();
+
+    std::unordered_map<uint64_t, uint64_t> traffic;
+    std::vector<std::pair<TcpConnection *, uint64_t>> recent;
+
+    traffic.reserve(pShard->connections.size());
+    recent.reserve(pShard->connections.size());
+
+    uint64_t totalBytes = 0;
+
+    for (const auto &item : pShard->connections) {
+        const TrafficCounters &counters = item.second->trafficCounters();
+        const uint64_t bytes = counters.bytesRead + counters.bytesWritten;
+
+        // New here, all of its traffic counts
+        const auto it = pShard->rebalanceTraffic.find(item.first);
+        const uint64_t delta = bytes - (it != pShard->rebalanceTraffic.end() ? it->second : 0);
+
+        traffic.emplace(item.first, bytes);
+        recent.emplace_back(item.second.get(), delta);
+        totalBytes += delta;
+    }
+
+    pShard->rebalanceTraffic.swap(traffic);
+
+    if (totalBytes == 0) {
+        return;
+    }
+
+    // Busy time is assumed to follow traffic
+    const double maxShare = 0.5 * static_cast<double>(gap.count()) / static_cast<double>(busyTime.count());
+
+    TcpConnection *pHottest = nullptr;
+    uint64_t hottestBytes = 0;
+
+    for (const auto &[pConn, delta] : recent) {
+        if (delta > hottestBytes && static_cast<double>(delta) < maxShare * static_cast<double>(totalBytes) &&
+            pConn->connected() && pConn->canMigrate()) {
+            pHottest = pConn;
+            hottestBytes = delta;
+        }
+    }
+
+    if (!pHottest) {
+        return;
+    }
+
+    if (spdlog::should_log(spdlog::level::info)) {
+        MINI_MUDUO_LOG_INFO("TcpServer::migrateHottestInLoop [{}] - connection {}, {} of {} bytes",
+                            name_,
+                            pHottest->name(),
+                            hottestBytes,
+                            totalBytes);
+    }
+
+    pHottest->migrateTo(pNewLoop);
+}
+
+void TcpServer::getBufferStats(BufferStatsCallback cb) {
+    pOwnerMainLoop_->runInLoop([this, cb = std::move(cb)] {
+        if (this->shards_.empty()) {
+            cb(BufferStats{});
+            return;
+        }
+
+        // Partial sums are merged in the main loop, no lock needed
+        auto total = std::make_shared<BufferStats>();
+        auto remaining = std::make_shared<size_t>(this->shards_.size());
 
-    const size_t n = connections_.erase(conn->name());
+        for (const auto &shard : this->shards_) {
+            shard->pLoop->runInLoop([this, shard, total, remaining, cb] {
+                BufferStats partial;
+
+                for (const auto &item : shard->connections) {
+                    const TcpConnectionPtr &conn = item.second;
+
+                    partial.connections++;
+                    partial.bufferedBytes += conn->bufferedBytes();
+                    partial.reservedBytes += conn->reservedBytes();
+                    partial.pinnedBytes += conn->zeroCopyPinnedBytes();
+                }
+
+                this->pOwnerMainLoop_->runInLoop([partial, total, remaining, cb] {
+                    total->connections += partial.connections;
+                    total->bufferedBytes += partial.bufferedBytes;
+                    total->reservedBytes += partial.reservedBytes;
+                    total->pinnedBytes += partial.pinnedBytes;
+
+                    if (--*remaining == 0) {
+                        cb(*total);
+                    }
+                });
+            });
+        }
+    });
+}
+
+void TcpServer::getTrafficStats(TrafficStatsCallback cb) {
+    pOwnerMainLoop_->runInLoop([this, cb = std::move(cb)] {
+        if (this->shards_.empty()) {
+            cb({});
+            return;
+        }
+
+        auto stats = std::make_shared<std::vector<LoopTrafficStats>>();
+        auto remaining = std::make_shared<size_t>(this->shards_.size());
+
+        for (const auto &shard : this->shards_) {
+            shard->pLoop->runInLoop([this, shard, stats, remaining, cb] {
+                LoopTrafficStats partial;
+                partial.pLoop = shard->pLoop;
+
+                uint64_t busiestBytes = 0;
+                std::chrono::nanoseconds longestQueued{0};
+
+                for (const auto &item : shard->connections) {
+                    const TcpConnectionPtr &conn = item.second;
+                    const TrafficCounters &counters = conn->trafficCounters();
+
+                    partial.connections++;
+                    partial.total += counters;
+
+                    if (counters.bytesRead + counters.bytesWritten > busiestBytes) {
+                        busiestBytes = counters.bytesRead + counters.bytesWritten;
+                        partial.busiestConnection = conn->name();
+                    }
+
+                    if (counters.outputQueuedTime > longestQueued) {
+                        longestQueued = counters.outputQueuedTime;
+                        partial.mostQueuedConnection = conn->name();
+                    }
+                }
+
+                this->pOwnerMainLoop_->runInLoop([partial = std::move(partial), stats, remaining, cb]() mutable {
+                    stats->push_back(std::move(partial));
+
+                    if (--*remaining == 0) {
+                        cb(*stats);
+                    }
+                });
+            });
+        }
+    });
+}
+
+void TcpServer::sampleTcpInfo() {
+    for (const auto &shard : shards_) {
+        shard->pLoop->runInLoop([shard] {
+            for (const auto &item : shard->connections) {
+                if (item.second->connected()) {
+                    item.second->sampleTcpInfo();
+                }
+            }
+        });
+    }
+}
+
+void TcpServer::removeConnectionInLoop(LoopShard *pShard, const TcpConnectionPtr &conn) {
+    pShard->pLoop->assertInLoopThread();
+
+    if (spdlog::should_log(spdlog::level::info)) {
+        MINI_MUDUO_LOG_INFO("TcpServer::removeConnectionInLoop [{}] - connection {}", name_, conn->name());
+    }
+
+    const size_t n = pShard->connections.erase(conn->id());
     (void)n;
     assert(n == 1);
 
-    EventLoop *pIoLoop = conn->getLoop();
+    threadPool_.connectionClosed(pShard->pLoop);
 
-    pIoLoop->queueInLoop([conn] {
+    pShard->pLoop->queueInLoop([conn] {
         conn->onConnectionDestroyed();
     });
+
+    // Queued even in the main loop, the callback may destroy this server,
+    // so never more than one is queued
+    if (draining() && !drainCheckQueued_.exchange(true, std::memory_order_acq_rel)) {
+        pOwnerMainLoop_->queueInLoop([this] {
+            this->drainCheckQueued_.store(false, std::memory_order_release);
+            this->callDrainedCallbackIfDrained();
+        });
+    }
 }
 
 }  // namespace mini_muduo
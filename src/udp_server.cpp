@@ -0,0 +1,82 @@
+#include <mini_muduo/udp_server.h>
+
+#include <future>
+#include <utility>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/log.h>
+
+namespace mini_muduo {
+
+UdpServer::UdpServer(
+    EventLoop *pLoop, const InetAddress &listenAddr, std::string name, int nThreads, UdpSocket::Options options)
+    : pOwnerMainLoop_(pLoop)
+    , name_(std::move(name))
+    , listenAddr_(listenAddr)
+    , options_(options)
+    , threadPool_(pLoop, nThreads) {}
+
+UdpServer::~UdpServer() {
+    pOwnerMainLoop_->assertInLoopThread();
+
+    std::vector<std::future<void>> socketsClosed;
+
+    // A socket calls back into its loop until it is closed there
+    for (auto &socket : sockets_) {
+        auto closed = std::make_shared<std::promise<void>>();
+        socketsClosed.push_back(closed->get_future());
+
+        EventLoop *pLoop = socket->getLoop();
+
+        pLoop->runInLoop([socket = std::move(socket), closed]() mutable {
+            socket.reset();
+            closed->set_value();
+        });
+    }
+
+    for (auto &closed : socketsClosed) {
+        closed.wait();
+    }
+}
+
+void UdpServer::start() {
+    std::call_once(startOnce_, [this] {
+        this->threadPool_.start();
+
+        const std::vector<EventLoop *> &loops = this->threadPool_.getAllLoops();
+
+        UdpSocket::Options options = this->options_;
+        options.reusePort = options.reusePort || loops.size() > 1;
+
+        std::vector<std::future<void>> receiving;
+
+        for (size_t i = 0; i < loops.size(); i++) {
+            // Bound here, so that a taken port fails in the caller's thread
+            auto socket = std::make_shared<UdpSocket>(
+                loops[i], this->listenAddr_, this->name_ + "#" + std::to_string(i + 1), options);
+            socket->setMessageCallback(this->messageCb_);
+
+            auto started = std::make_shared<std::promise<void>>();
+            receiving.push_back(started->get_future());
+
+            loops[i]->runInLoop([socket, started] {
+                socket->start();
+                started->set_value();
+            });
+
+            this->sockets_.push_back(std::move(socket));
+        }
+
+        // Datagrams may arrive as soon as start() returns
+        for (auto &started : receiving) {
+            started.wait();
+        }
+
+        MINI_MUDUO_LOG_INFO("UdpServer [{}] - receiving on {} with {} sockets",
+                            this->name_,
+                            this->listenAddr_.toIpPort(),
+                            this->sockets_.size());
+    });
+}
+
+}  // namespace mini_muduo
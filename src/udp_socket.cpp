@@ -0,0 +1,347 @@
+#include <mini_muduo/udp_socket.h>
+
+#include <netinet/udp.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include "socket.h"
+
+#include <mini_muduo/channel.h>
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/log.h>
+#include <mini_muduo/socket_ops.h>
+
+namespace mini_muduo {
+
+namespace {
+
+// Largest datagram GRO hands over
+constexpr size_t kGroSlotSize = 65535;
+
+// UDP_MAX_SEGMENTS of older kernels, newer ones take twice as many
+constexpr size_t kMaxGsoSegments = 64;
+
+// A GSO message is one UDP packet to the stack, headers of IPv6 and UDP included
+constexpr size_t kMaxGsoBytes = 65535 - 40 - 8;
+
+const size_t kGroControlSize = CMSG_SPACE(sizeof(int));
+const size_t kGsoControlSize = CMSG_SPACE(sizeof(uint16_t));
+
+bool samePeer(const InetAddress &lhs, const InetAddress &rhs) {
+    return lhs.getSockAddrLen() == rhs.getSockAddrLen() &&
+           memcmp(lhs.getSockAddr(), rhs.getSockAddr(), lhs.getSockAddrLen()) == 0;
+}
+
+}  // namespace
+
+UdpSocket::UdpSocket(EventLoop *pLoop, const InetAddress &localAddr, std::string name, Options options)
+    : pOwnerLoop_(pLoop)
+    , name_(std::move(name))
+    , options_(options)
+    , socket_(std::make_unique<Socket>(socket_ops::createNonblockingDatagramOrDie(localAddr.family())))
+    , channel_(std::make_unique<Channel>(pLoop, socket_->fd()))
+    , localAddr_(localAddr) {
+    assert(options_.batchSize > 0 && options_.maxDatagramSize > 0);
+
+    socket_->setReuseAddr(true);
+    socket_->setReusePort(options_.reusePort);
+    socket_->bind(localAddr);
+
+    localAddr_ = InetAddress(socket_ops::getLocalAddr(socket_->fd()));
+
+    if (options_.gro && !socket_->setUdpGro(true)) {
+        options_.gro = false;
+    }
+
+    const size_t batch = options_.batchSize;
+
+    receiveSlotSize_ = options_.gro ? kGroSlotSize : options_.maxDatagramSize;
+    receiveBuf_.resize(batch * receiveSlotSize_);
+    receiveMsgs_.resize(batch);
+    receiveIovecs_.resize(batch);
+    receivePeers_.resize(batch);
+    receiveControl_.resize(options_.gro ? batch * kGroControlSize : 0);
+
+    for (size_t i = 0; i < batch; i++) {
+        receiveIovecs_[i].iov_base = receiveBuf_.data() + i * receiveSlotSize_;
+        receiveIovecs_[i].iov_len = receiveSlotSize_;
+
+        memset(&receiveMsgs_[i], 0, sizeof(receiveMsgs_[i]));
+        receiveMsgs_[i].msg_hdr.msg_name = &receivePeers_[i];
+        receiveMsgs_[i].msg_hdr.msg_iov = &receiveIovecs_[i];
+        receiveMsgs_[i].msg_hdr.msg_iovlen = 1;
+
+        if (options_.gro) {
+            receiveMsgs_[i].msg_hdr.msg_control = receiveControl_.data() + i * kGroControlSize;
+        }
+    }
+
+    sendMsgs_.resize(batch);
+    sendIovecs_.resize(batch);
+    sendControl_.resize(batch * kGsoControlSize);
+    sendSegments_.resize(batch);
+
+    channel_->setReadCallback([this](Timestamp receiveTime) {
+        this->handleRead(receiveTime);
+    });
+
+    channel_->setWriteCallback([this] {
+        this->handleWrite();
+    });
+}
+
+UdpSocket::~UdpSocket() {
+    pOwnerLoop_->assertInLoopThread();
+
+    // Best effort, what does not fit in the socket buffer is lost
+    flush();
+
+    channel_->disableAll();
+    channel_->remove();
+}
+
+void UdpSocket::start() {
+    pOwnerLoop_->assertInLoopThread();
+
+    if (!channel_->isReading()) {
+        channel_->enableReading();
+    }
+}
+
+void UdpSocket::handleRead(Timestamp receiveTime) {
+    pOwnerLoop_->assertInLoopThread();
+
+    // The kernel overwrote the lengths of the last batch
+    for (auto &msg : receiveMsgs_) {
+        msg.msg_hdr.msg_namelen = static_cast<socklen_t>(sizeof(struct sockaddr_storage));
+        msg.msg_hdr.msg_controllen = options_.gro ? kGroControlSize : 0;
+        msg.msg_hdr.msg_flags = 0;
+    }
+
+    const int n = socket_ops::recvmmsg(socket_->fd(), receiveMsgs_.data(), receiveMsgs_.size());
+
+    stats_.receiveCalls++;
+
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+            MINI_MUDUO_LOG_ERROR("UdpSocket::handleRead[{}] {}", name_, strerror_tl(errno));
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(n); i++) {
+        const struct msghdr &hdr = receiveMsgs_[i].msg_hdr;
+        const char *pData = receiveBuf_.data() + i * receiveSlotSize_;
+        const size_t len = std::min(static_cast<size_t>(receiveMsgs_[i].msg_len), receiveSlotSize_);
+
+        if (hdr.msg_flags & MSG_TRUNC) {
+            stats_.datagramsTruncated++;
+        }
+
+        // Coalesced by GRO, all but the last of the same size
+        size_t segmentSize = len;
+
+        for (const struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&hdr); pCmsg;
+             pCmsg = CMSG_NXTHDR(const_cast<struct msghdr *>(&hdr), const_cast<struct cmsghdr *>(pCmsg))) {
+            if (pCmsg->cmsg_level == IPPROTO_UDP && pCmsg->cmsg_type == UDP_GRO) {
+                int gsoSize;
+                memcpy(&gsoSize, CMSG_DATA(pCmsg), sizeof(gsoSize));
+
+                if (gsoSize > 0) {
+                    segmentSize = static_cast<size_t>(gsoSize);
+                }
+            }
+        }
+
+        const InetAddress peerAddr(receivePeers_[i]);
+
+        size_t offset = 0;
+
+        do {
+            const size_t segmentLen = std::min(segmentSize, len - offset);
+
+            stats_.datagramsReceived++;
+
+            if (messageCb_) {
+                messageCb_(*this, peerAddr, std::string_view(pData + offset, segmentLen), receiveTime);
+            }
+
+            offset += segmentLen;
+        } while (offset < len);
+    }
+}
+
+bool UdpSocket::send(const InetAddress &peerAddr, std::string_view data) {
+    pOwnerLoop_->assertInLoopThread();
+
+    if (sendBuf_.size() + data.size() > options_.maxQueuedBytes) {
+        stats_.datagramsDropped++;
+        return false;
+    }
+
+    sendQueue_.push_back(QueuedDatagram{peerAddr, sendBuf_.size(), data.size()});
+    sendBuf_.append(data);
+
+    // Otherwise handleWrite() will get to it
+    if (!flushScheduled_ && !channel_->isWriting()) {
+        flushScheduled_ = true;
+
+        pOwnerLoop_->runAtIterationEnd([this, alive = std::weak_ptr<bool>(alive_)] {
+            if (alive.expired()) {
+                return;
+            }
+
+            this->flushScheduled_ = false;
+            this->flush();
+        });
+    }
+
+    return true;
+}
+
+void UdpSocket::handleWrite() {
+    pOwnerLoop_->assertInLoopThread();
+
+    flush();
+}
+
+size_t UdpSocket::segmentsFrom(size_t first) const {
+    const QueuedDatagram &head = sendQueue_[first];
+
+    if (head.len == 0) {
+        return 1;
+    }
+
+    size_t count = 1;
+    size_t bytes = head.len;
+
+    // The kernel cuts at the size of the first, only the last may be shorter
+    while (first + count < sendQueue_.size() && count < kMaxGsoSegments) {
+        const QueuedDatagram &next = sendQueue_[first + count];
+
+        if (next.len == 0 || next.len > head.len || bytes + next.len > kMaxGsoBytes ||
+            !samePeer(next.peerAddr, head.peerAddr)) {
+            break;
+        }
+
+        count++;
+        bytes += next.len;
+
+        if (next.len < head.len) {
+            break;
+        }
+    }
+
+    return count;
+}
+
+void UdpSocket::flush() {
+    size_t sent = 0;
+
+    while (sent < sendQueue_.size()) {
+        size_t nMsgs = 0;
+        size_t next = sent;
+
+        while (nMsgs < sendMsgs_.size() && next < sendQueue_.size()) {
+            const size_t segments = options_.gso ? segmentsFrom(next) : 1;
+            const QueuedDatagram &head = sendQueue_[next];
+            const QueuedDatagram &tail = sendQueue_[next + segments - 1];
+
+            // Queued back to back, one iovec covers them all
+            sendIovecs_[nMsgs].iov_base = sendBuf_.data() + head.offset;
+            sendIovecs_[nMsgs].iov_len = tail.offset + tail.len - head.offset;
+
+            struct msghdr &hdr = sendMsgs_[nMsgs].msg_hdr;
+
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_name = const_cast<struct sockaddr *>(head.peerAddr.getSockAddr());
+            hdr.msg_namelen = head.peerAddr.getSockAddrLen();
+            hdr.msg_iov = &sendIovecs_[nMsgs];
+            hdr.msg_iovlen = 1;
+
+            if (segments > 1) {
+                hdr.msg_control = sendControl_.data() + nMsgs * kGsoControlSize;
+                hdr.msg_controllen = kGsoControlSize;
+
+                struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&hdr);
+                pCmsg->cmsg_level = IPPROTO_UDP;
+                pCmsg->cmsg_type = UDP_SEGMENT;
+                pCmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+                const auto segmentSize = static_cast<uint16_t>(head.len);
+                memcpy(CMSG_DATA(pCmsg), &segmentSize, sizeof(segmentSize));
+            }
+
+            sendSegments_[nMsgs] = segments;
+            next += segments;
+            nMsgs++;
+        }
+
+        const int n = socket_ops::sendmmsg(socket_->fd(), sendMsgs_.data(), nMsgs);
+
+        stats_.sendCalls++;
+
+        if (n < 0) {
+            if (errno == EAGAIN) {
+                break;
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Not every device and path takes GSO, send them one by one from now on
+            if (sendSegments_[0] > 1 && (errno == EIO || errno == EINVAL)) {
+                MINI_MUDUO_LOG_WARN("UdpSocket::flush[{}] UDP_SEGMENT {}, disabled", name_, strerror_tl(errno));
+                options_.gso = false;
+                continue;
+            }
+
+            // The first message fails, the rest may not
+            MINI_MUDUO_LOG_ERROR("UdpSocket::flush[{}] {}", name_, strerror_tl(errno));
+
+            stats_.datagramsDropped += sendSegments_[0];
+            sent += sendSegments_[0];
+            continue;
+        }
+
+        // A short count stops at a failing message, the next call reports it
+        for (size_t i = 0; i < static_cast<size_t>(n); i++) {
+            stats_.datagramsSent += sendSegments_[i];
+            sent += sendSegments_[i];
+        }
+    }
+
+    if (sent == sendQueue_.size()) {
+        sendQueue_.clear();
+        sendBuf_.clear();
+
+        if (channel_->isWriting()) {
+            channel_->disableWriting();
+        }
+
+        return;
+    }
+
+    if (sent > 0) {
+        const size_t sentBytes = sendQueue_[sent].offset;
+
+        sendBuf_.erase(0, sentBytes);
+        sendQueue_.erase(sendQueue_.begin(), sendQueue_.begin() + static_cast<std::ptrdiff_t>(sent));
+
+        for (auto &datagram : sendQueue_) {
+            datagram.offset -= sentBytes;
+        }
+    }
+
+    // The socket buffer is full, wait until it drains
+    if (!channel_->isWriting()) {
+        channel_->enableWriting();
+    }
+}
+
+}  // namespace mini_muduo
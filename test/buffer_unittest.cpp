@@ -1,5 +1,7 @@
 // Taken from authentic muduo
-#include <mini_muduo/Buffer.h>
+#include <mini_muduo/buffer.h>
+
+#include <unistd.h>
 
 // #define BOOST_TEST_MODULE BufferTest
 #define BOOST_TEST_MAIN
@@ -100,6 +102,26 @@ BOOST_AUTO_TEST_CASE(testBufferShrink) {
     BOOST_CHECK_EQUAL(buf.prependableBytes(), Buffer::kCheapPrepend);
 }
 
+BOOST_AUTO_TEST_CASE(testBufferShrinkToFit) {
+    Buffer buf(0);
+    BOOST_CHECK_EQUAL(buf.writableBytes(), 0);
+    BOOST_CHECK_EQUAL(buf.internalCapacity(), Buffer::kCheapPrepend);
+
+    buf.append(string(5000, 'y'));
+    buf.retrieve(4000);
+    BOOST_CHECK_EQUAL(buf.readableBytes(), 1000);
+
+    buf.shrinkToFit();
+    BOOST_CHECK_EQUAL(buf.readableBytes(), 1000);
+    BOOST_CHECK_EQUAL(buf.writableBytes(), 0);
+    BOOST_CHECK_EQUAL(buf.internalCapacity(), Buffer::kCheapPrepend + 1000);
+    BOOST_CHECK_EQUAL(buf.retrieveAllAsString(), string(1000, 'y'));
+
+    buf.shrinkToFit();
+    BOOST_CHECK_EQUAL(buf.internalCapacity(), Buffer::kCheapPrepend);
+    BOOST_CHECK_EQUAL(buf.prependableBytes(), Buffer::kCheapPrepend);
+}
+
 BOOST_AUTO_TEST_CASE(testBufferPrepend) {
     Buffer buf;
     buf.append(string(200, 'y'));
@@ -147,6 +169,24 @@ BOOST_AUTO_TEST_CASE(testBufferFindEOL) {
     BOOST_CHECK_EQUAL(buf.findEOL(buf.peek() + 90000), null);
 }
 
+BOOST_AUTO_TEST_CASE(testBufferReadFdBudget) {
+    int fds[2];
+    BOOST_REQUIRE(::pipe(fds) == 0);
+    BOOST_REQUIRE(::write(fds[1], string(50000, 'x').data(), 50000) == 50000);
+
+    Buffer buf;
+    int savedErrno = 0;
+
+    // Both into the buffer itself and into the extra buffer on the stack
+    BOOST_CHECK_EQUAL(buf.readFd(fds[0], &savedErrno, 100), 100);
+    BOOST_CHECK_EQUAL(buf.readableBytes(), 100);
+    BOOST_CHECK_EQUAL(buf.readFd(fds[0], &savedErrno, 10000), 10000);
+    BOOST_CHECK_EQUAL(buf.readableBytes(), 10100);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
 void output(Buffer &&buf, const void *inner) {
     Buffer newbuf(std::move(buf));
     // printf("New Buffer at %p, inner %p\n", &newbuf, newbuf.peek());
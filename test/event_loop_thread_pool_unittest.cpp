@@ -0,0 +1,147 @@
+#include <mini_muduo/event_loop_thread_pool.h>
+
+#include <sched.h>
+
+#include <chrono>
+#include <future>
+#include <vector>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/timestamp.h>
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace mini_muduo;
+using SelectionPolicy = EventLoopThreadPool::SelectionPolicy;
+
+BOOST_AUTO_TEST_CASE(testLeastConnections) {
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, 3);
+    pool.setSelectionPolicy(SelectionPolicy::LEAST_CONNECTIONS);
+    pool.start();
+
+    const auto &loops = pool.getAllLoops();
+
+    pool.connectionOpened(loops[0]);
+    pool.connectionOpened(loops[0]);
+    pool.connectionOpened(loops[1]);
+
+    BOOST_CHECK_EQUAL(pool.selectLoop(InetAddress()), loops[2]);
+
+    pool.connectionOpened(loops[2]);
+    pool.connectionOpened(loops[2]);
+    pool.connectionClosed(loops[0]);
+    pool.connectionClosed(loops[0]);
+
+    BOOST_CHECK_EQUAL(pool.selectLoop(InetAddress()), loops[0]);
+    BOOST_CHECK_EQUAL(pool.connectionCount(loops[2]), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(testPowerOfTwoChoices) {
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, 2);
+    pool.setSelectionPolicy(SelectionPolicy::POWER_OF_TWO_CHOICES);
+    pool.start();
+
+    const auto &loops = pool.getAllLoops();
+
+    pool.connectionOpened(loops[0]);
+
+    // With two loops both are always the choices
+    for (int i = 0; i < 10; i++) {
+        BOOST_CHECK_EQUAL(pool.selectLoop(InetAddress()), loops[1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testLeastBusy) {
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, 2);
+    pool.setSelectionPolicy(SelectionPolicy::LEAST_BUSY);
+    pool.start();
+
+    const auto &loops = pool.getAllLoops();
+
+    std::promise<void> spun;
+
+    loops[0]->runInLoop([&spun] {
+        const Timestamp start = Timestamp::now();
+
+        while (Timestamp::now().timePoint() - start.timePoint() < std::chrono::milliseconds(50)) {
+        }
+
+        spun.set_value();
+    });
+
+    spun.get_future().wait();
+
+    // Busy time is added once the iteration ends
+    std::promise<void> iterated;
+
+    loops[0]->runInLoop([&iterated] {
+        iterated.set_value();
+    });
+
+    iterated.get_future().wait();
+
+    BOOST_CHECK(loops[0]->busyTime() >= std::chrono::milliseconds(50));
+    BOOST_CHECK_EQUAL(pool.selectLoop(InetAddress()), loops[1]);
+}
+
+BOOST_AUTO_TEST_CASE(testPeerAddressHash) {
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, 4);
+    pool.setSelectionPolicy(SelectionPolicy::PEER_ADDRESS_HASH);
+    pool.start();
+
+    EventLoop *pLoop = pool.selectLoop(InetAddress("10.0.0.1", 40000));
+
+    for (uint16_t port = 40001; port < 40010; port++) {
+        BOOST_CHECK_EQUAL(pool.selectLoop(InetAddress("10.0.0.1", port)), pLoop);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPlacement) {
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, 2);
+    pool.setThreadPlacement({{0}}, true);
+    pool.start();
+
+    for (EventLoop *pIoLoop : pool.getAllLoops()) {
+        std::promise<int> pinnedCpus;
+
+        pIoLoop->runInLoop([&pinnedCpus] {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            (void)sched_getaffinity(0, sizeof(cpuSet), &cpuSet);
+
+            pinnedCpus.set_value(CPU_ISSET(0, &cpuSet) ? CPU_COUNT(&cpuSet) : -1);
+        });
+
+        BOOST_CHECK_EQUAL(pinnedCpus.get_future().get(), 1);
+        BOOST_CHECK(pool.cpusOf(pIoLoop) == std::vector<int>{0});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testPromptShutdown) {
+    EventLoop loop;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    {
+        EventLoopThreadPool pool(&loop, 8);
+        pool.start();
+
+        BOOST_CHECK_EQUAL(pool.getAllLoops().size(), 8u);
+    }
+
+    // Quit right after start, before the loop may have run at all
+    for (int i = 0; i < 20; i++) {
+        EventLoopThread thread;
+        thread.start();
+    }
+
+    BOOST_CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(1));
+}
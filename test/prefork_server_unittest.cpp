@@ -0,0 +1,139 @@
+#include <mini_muduo/prefork_server.h>
+
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/tcp_client.h>
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace mini_muduo;
+using std::string;
+
+static const uint16_t kPort = 20380;
+
+static void echo(const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+    conn->send(buf);
+}
+
+BOOST_AUTO_TEST_CASE(testRestartsCrashedWorker) {
+    EventLoop loop;
+
+    PreforkServer server(&loop, InetAddress(kPort, true), "PreforkServer", 2);
+    server.setStatsInterval(std::chrono::milliseconds(20));
+    server.setRestartDelay(std::chrono::milliseconds(10));
+    server.setWorkerInitCallback([](TcpServer &workerServer) {
+        workerServer.setMessageCallback(echo);
+    });
+    server.start();
+
+    BOOST_CHECK_EQUAL(server.workerStats().size(), 2u);
+    BOOST_CHECK_GT(server.workerStats()[0].pid, 0);
+    BOOST_CHECK_GT(server.workerStats()[1].pid, 0);
+
+    TcpClient before(&loop, InetAddress("127.0.0.1", kPort), "BeforeCrash");
+    TcpClient after(&loop, InetAddress("127.0.0.1", kPort), "AfterCrash");
+
+    string receivedBefore;
+    string receivedAfter;
+    size_t reportedConnections = 0;
+    pid_t crashedPid = 0;
+    pid_t restartedPid = 0;
+
+    for (TcpClient *pClient : {&before, &after}) {
+        pClient->setConnectionCallback([](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->send("ping");
+            }
+        });
+    }
+
+    before.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        receivedBefore += buf.retrieveAllAsString();
+    });
+
+    after.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        receivedAfter += buf.retrieveAllAsString();
+
+        if (receivedAfter.size() >= 4) {
+            loop.quit();
+        }
+    });
+
+    before.connect();
+
+    // Crash a worker once the echoed connection is reported, connect again once it is back
+    loop.runEvery(std::chrono::milliseconds(10), [&] {
+        const PreforkServer::WorkerStats &first = server.workerStats()[0];
+
+        if (crashedPid == 0) {
+            reportedConnections = server.totalStats().connections;
+
+            if (receivedBefore.size() >= 4 && reportedConnections >= 1) {
+                crashedPid = first.pid;
+                ::kill(crashedPid, SIGKILL);
+            }
+        } else if (restartedPid == 0 && first.pid > 0 && first.restarts == 1) {
+            restartedPid = first.pid;
+            after.connect();
+        }
+    });
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_EQUAL(receivedBefore, "ping");
+    BOOST_CHECK_EQUAL(reportedConnections, 1u);
+    BOOST_CHECK_GT(crashedPid, 0);
+    BOOST_CHECK_GT(restartedPid, 0);
+    BOOST_CHECK_NE(restartedPid, crashedPid);
+    BOOST_CHECK_EQUAL(server.totalStats().restarts, 1u);
+    BOOST_CHECK_EQUAL(receivedAfter, "ping");
+
+    before.disconnect();
+    after.disconnect();
+}
+
+BOOST_AUTO_TEST_CASE(testKillsHungWorker) {
+    EventLoop loop;
+
+    auto server = std::make_unique<PreforkServer>(&loop, InetAddress(kPort + 1, true), "PreforkServer", 1);
+
+    // SIGTERM is read from a signalfd by then, nothing ever reads it
+    server->setWorkerInitCallback([](TcpServer &) {
+        for (;;) {
+            ::pause();
+        }
+    });
+    server->start();
+
+    loop.runAfter(std::chrono::milliseconds(200), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    const pid_t pid = server->workerStats()[0].pid;
+    BOOST_REQUIRE_GT(pid, 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    server.reset();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Killed after the stop timeout and reaped
+    BOOST_CHECK(elapsed >= std::chrono::seconds(4));
+    BOOST_CHECK(elapsed < std::chrono::seconds(10));
+    BOOST_CHECK_EQUAL(::kill(pid, 0), -1);
+}
@@ -0,0 +1,1421 @@
+#include <mini_muduo/tcp_connection.h>
+
+#include <sched.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/socket_ops.h>
+#include <mini_muduo/tcp_client.h>
+#include <mini_muduo/tcp_relay.h>
+#include <mini_muduo/tcp_server.h>
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace mini_muduo;
+using std::string;
+
+static const uint16_t kPort = 20260;
+
+// Runs a server that calls @c onConnected for each new connection,
+// returns everything the client receives before the server closes.
+static string receiveAll(const std::function<void(const TcpConnectionPtr &)> &onConnected) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort), "TestClient");
+    string received;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            onConnected(conn);
+            conn->shutdown();
+        }
+    });
+
+    client.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        received += buf.retrieveAllAsString();
+    });
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->disconnected()) {
+            loop.quit();
+        }
+    });
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    return received;
+}
+
+BOOST_AUTO_TEST_CASE(testSendKeepsOrderAcrossSegments) {
+    // Large enough to fill the socket buffer, so later pieces get queued
+    const string big(4 * 1024 * 1024, 'a');
+    const auto shared = std::make_shared<const string>(1024 * 1024, 'd');
+    static const char kStatic[] = "static";
+
+    string expected;
+
+    const string received = receiveAll([&](const TcpConnectionPtr &conn) {
+        conn->send(big);
+        expected += big;
+
+        conn->send(string(100000, 'b'));
+        expected += string(100000, 'b');
+
+        conn->send("small");
+        expected += "small";
+
+        Buffer buf;
+        buf.append(string(300000, 'c'));
+        conn->send(std::move(buf));
+        expected += string(300000, 'c');
+
+        conn->send(shared, *shared);
+        expected += *shared;
+
+        conn->sendStatic(kStatic);
+        expected += kStatic;
+
+        conn->send(string(10, 'e'));
+        expected += string(10, 'e');
+    });
+
+    BOOST_CHECK_EQUAL(received.size(), expected.size());
+    BOOST_CHECK(received == expected);
+}
+
+BOOST_AUTO_TEST_CASE(testSendMovedStringsAndBuffers) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 14, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort + 14), "TestClient");
+    string expected;
+    string received;
+    bool sourcesEmptied = true;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (!conn->connected()) {
+            return;
+        }
+
+        // Large enough to fill the socket buffer, so later pieces get queued
+        string big(4 * 1024 * 1024, 'a');
+        expected += big;
+        conn->send(std::move(big));
+        sourcesEmptied = sourcesEmptied && big.empty();
+
+        Buffer buf;
+        buf.append(string(300000, 'b'));
+        expected += string(300000, 'b');
+        conn->send(std::move(buf));
+        sourcesEmptied = sourcesEmptied && buf.readableBytes() == 0;
+
+        // BOOST_CHECK is not thread safe, report back instead
+        bool threadSourcesEmptied = true;
+        expected += string(200000, 'c') + string(100, 'd') + "e";
+
+        std::thread([&, conn] {
+            string str(200000, 'c');
+            conn->send(std::move(str));
+            threadSourcesEmptied = threadSourcesEmptied && str.empty();
+
+            Buffer threadBuf;
+            threadBuf.append(string(100, 'd'));
+            conn->send(std::move(threadBuf));
+            threadSourcesEmptied = threadSourcesEmptied && threadBuf.readableBytes() == 0;
+
+            string small = "e";
+            conn->send(std::move(small));
+            threadSourcesEmptied = threadSourcesEmptied && small.empty();
+        }).join();
+
+        sourcesEmptied = sourcesEmptied && threadSourcesEmptied;
+
+        // After the sends the thread queued
+        loop.queueInLoop([conn] {
+            conn->shutdown();
+        });
+    });
+
+    client.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        received += buf.retrieveAllAsString();
+    });
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->disconnected()) {
+            loop.quit();
+        }
+    });
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK(sourcesEmptied);
+    BOOST_CHECK_EQUAL(received.size(), expected.size());
+    BOOST_CHECK(received == expected);
+}
+
+BOOST_AUTO_TEST_CASE(testSendFileKeepsOrder) {
+    char path[] = "/tmp/tcp_connection_unittest_XXXXXX";
+    const int fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    ::unlink(path);
+
+    string content;
+    for (int i = 0; i < 3 * 1024 * 1024; i++) {
+        content.push_back(static_cast<char>('a' + i % 26));
+    }
+    BOOST_REQUIRE(::write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+
+    const string received = receiveAll([&](const TcpConnectionPtr &conn) {
+        conn->send("header\r\n");
+        conn->sendFile(fd, 1000, content.size() - 2000);
+        conn->send("trailer");
+    });
+
+    ::close(fd);
+
+    BOOST_CHECK(received == "header\r\n" + content.substr(1000, content.size() - 2000) + "trailer");
+}
+
+BOOST_AUTO_TEST_CASE(testAutoCorkFlushesAtIterationEnd) {
+    string expected;
+    uint64_t writeCallsBefore = 0;
+    uint64_t writeCallsAfterFlush = 0;
+
+    const string received = receiveAll([&](const TcpConnectionPtr &conn) {
+        conn->setAutoCork(true);
+
+        writeCallsBefore = conn->trafficCounters().writeCalls;
+
+        for (int i = 0; i < 100; i++) {
+            const string piece = std::to_string(i) + "\r\n";
+
+            conn->send(piece);
+            expected += piece;
+        }
+
+        conn->send(string(1024 * 1024, 'x'));
+        expected += string(1024 * 1024, 'x');
+
+        // Nothing written yet, shutdown() must wait for the flush
+        BOOST_CHECK(conn->bufferedBytes() == expected.size());
+        BOOST_CHECK_EQUAL(conn->trafficCounters().writeCalls, writeCallsBefore);
+
+        // Runs after the flush, which was scheduled by the first send()
+        conn->getLoop()->runAtIterationEnd([&, conn] {
+            writeCallsAfterFlush = conn->trafficCounters().writeCalls;
+        });
+    });
+
+    // Every piece went out with the same writev(2)
+    BOOST_CHECK_EQUAL(writeCallsAfterFlush, writeCallsBefore + 1);
+    BOOST_CHECK(received == expected);
+}
+
+BOOST_AUTO_TEST_CASE(testReadBackpressure) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort), "TestClient");
+
+    const string request(16 * 1024 * 1024, 'r');
+    string echoed;
+    size_t maxBuffered = 0;
+    bool lowWaterMarkReached = false;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->setReadBackpressure(256 * 1024, 64 * 1024);
+            conn->setHighWaterMarkCallback([](const TcpConnectionPtr &, size_t) {}, 256 * 1024);
+            conn->setLowWaterMarkCallback(
+                [&](const TcpConnectionPtr &, size_t) {
+                    lowWaterMarkReached = true;
+                },
+                64 * 1024);
+        }
+    });
+
+    // Echo everything back
+    server.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        conn->send(buf);
+
+        maxBuffered = std::max(maxBuffered, conn->bufferedBytes());
+    });
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            // Do not read the replies until the server had to stop reading
+            conn->stopRead();
+            conn->send(request);
+
+            loop.runAfter(std::chrono::milliseconds(500), [&loop, conn] {
+                conn->startRead();
+            });
+        }
+    });
+
+    client.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        echoed += buf.retrieveAllAsString();
+
+        if (echoed.size() == request.size()) {
+            loop.quit();
+        }
+    });
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    // Far less than what the client pushed while not reading
+    BOOST_CHECK_LT(maxBuffered, 1024 * 1024);
+    BOOST_CHECK(lowWaterMarkReached);
+    BOOST_CHECK(echoed == request);
+}
+
+BOOST_AUTO_TEST_CASE(testRelayEchoWithHalfClose) {
+    EventLoop loop;
+
+    // client --> proxy --> echo
+    TcpServer echo(&loop, InetAddress(kPort + 1, true), "EchoServer");
+    TcpServer proxy(&loop, InetAddress(kPort, true), "ProxyServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort), "TestClient");
+
+    std::vector<std::unique_ptr<TcpClient>> upstreams;
+    bool relayed = false;
+
+    echo.setMessageCallback([](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        conn->send(buf);
+    });
+
+    proxy.setConnectionCallback([&](const TcpConnectionPtr &down) {
+        if (!down->connected()) {
+            return;
+        }
+
+        upstreams.push_back(std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort + 1), "Upstream"));
+
+        upstreams.back()->setConnectionCallback([&, down](const TcpConnectionPtr &up) {
+            if (up->connected()) {
+                relayed = TcpRelay::start(down, up);
+            }
+        });
+
+        // Nothing arrives before the relay runs
+        upstreams.back()->setMessageCallback(defaultMessageCallback);
+
+        upstreams.back()->connect();
+    });
+
+    // Not called once the relay runs
+    proxy.setMessageCallback([](const TcpConnectionPtr &, Buffer &, Timestamp) {});
+
+    const string request(4 * 1024 * 1024 + 123, 'q');
+    string echoed;
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send(request);
+            // EOF travels through the relay, the echo server closes after replying
+            conn->shutdown();
+        } else {
+            // Both ends half closed, the proxy closes its two connections
+            loop.runEvery(std::chrono::milliseconds(10), [&] {
+                if (proxy.connectionCount() == 0) {
+                    loop.quit();
+                }
+            });
+        }
+    });
+
+    client.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        echoed += buf.retrieveAllAsString();
+    });
+
+    echo.start();
+    proxy.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK(relayed);
+    BOOST_CHECK_EQUAL(echoed.size(), request.size());
+    BOOST_CHECK(echoed == request);
+    BOOST_CHECK_EQUAL(proxy.connectionCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testTcpInfoSampling) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort), "TestClient");
+
+    TcpInfo sampled;
+
+    server.setTcpInfoSampling(std::chrono::milliseconds(20));
+    server.setTcpNotSentLowat(16 * 1024);
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send(string(1024 * 1024, 's'));
+
+            loop.runAfter(std::chrono::milliseconds(200), [&, conn] {
+                sampled = conn->tcpInfo();
+                conn->shutdown();
+            });
+        }
+    });
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->disconnected()) {
+            loop.quit();
+        }
+    });
+
+    client.setMessageCallback(defaultMessageCallback);
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK(sampled.sampleTime.valid());
+    BOOST_CHECK_GT(sampled.congestionWindow, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testTrafficCounters) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort), "TestClient");
+
+    TrafficCounters counters;
+    std::vector<TcpServer::LoopTrafficStats> stats;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send("hello ");
+            conn->send("world");
+        }
+    });
+
+    server.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        buf.retrieveAll();
+
+        counters = conn->trafficCounters();
+
+        server.getTrafficStats([&, conn](const std::vector<TcpServer::LoopTrafficStats> &result) {
+            stats = result;
+            conn->shutdown();
+        });
+    });
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send("ping");
+        } else {
+            loop.quit();
+        }
+    });
+
+    client.setMessageCallback(defaultMessageCallback);
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_EQUAL(counters.bytesRead, 4u);
+    BOOST_CHECK_EQUAL(counters.messagesRead, 1u);
+    BOOST_CHECK_EQUAL(counters.bytesWritten, 11u);
+    BOOST_CHECK_EQUAL(counters.messagesWritten, 2u);
+    BOOST_CHECK_EQUAL(counters.writeCalls, 2u);
+    BOOST_CHECK_EQUAL(counters.partialWrites, 0u);
+
+    BOOST_REQUIRE_EQUAL(stats.size(), 1u);
+    BOOST_CHECK_EQUAL(stats[0].pLoop, &loop);
+    BOOST_CHECK_EQUAL(stats[0].connections, 1u);
+    BOOST_CHECK_EQUAL(stats[0].total.bytesWritten, 11u);
+    BOOST_CHECK(!stats[0].busiestConnection.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testOutputQueuedTimeWhileStalled) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 12, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort + 12), "TestClient");
+
+    std::vector<TcpServer::LoopTrafficStats> stats;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            // More than the socket buffers hold, the rest stays queued
+            conn->send(string(32 * 1024 * 1024, 's'));
+
+            loop.runAfter(std::chrono::milliseconds(200), [&] {
+                server.getTrafficStats([&](const std::vector<TcpServer::LoopTrafficStats> &result) {
+                    stats = result;
+                    loop.quit();
+                });
+            });
+        }
+    });
+
+    // Never reads, the server's queue does not drain
+    client.setConnectionCallback([](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->stopRead();
+        }
+    });
+
+    client.setMessageCallback(defaultMessageCallback);
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_REQUIRE_EQUAL(stats.size(), 1u);
+    BOOST_CHECK(stats[0].total.outputQueuedTime >= std::chrono::milliseconds(100));
+    BOOST_CHECK(!stats[0].mostQueuedConnection.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testIdleBufferTrim) {
+    static const size_t kBurstBytes = 256 * 1024;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 10, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort + 10), "TestClient");
+
+    server.setIdleBufferTrim(std::chrono::milliseconds(200));
+
+    TimerId sendTimer;
+    size_t activeReserved = 0;
+    size_t idleReserved = SIZE_MAX;
+
+    server.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        // Grows the input buffer to the whole burst
+        if (buf.readableBytes() < kBurstBytes) {
+            return;
+        }
+
+        buf.retrieveAll();
+
+        // Only writing from now on, which keeps the connection active as well
+        sendTimer = loop.runEvery(std::chrono::milliseconds(50), [conn] {
+            conn->send("x");
+        });
+
+        loop.runAfter(std::chrono::milliseconds(500), [&] {
+            server.getBufferStats([&](const TcpServer::BufferStats &stats) {
+                activeReserved = stats.reservedBytes;
+                loop.cancel(sendTimer);
+
+                loop.runAfter(std::chrono::milliseconds(500), [&] {
+                    server.getBufferStats([&](const TcpServer::BufferStats &stats) {
+                        idleReserved = stats.reservedBytes;
+                        loop.quit();
+                    });
+                });
+            });
+        });
+    });
+
+    client.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send(string(kBurstBytes, 'a'));
+        }
+    });
+
+    client.setMessageCallback(defaultMessageCallback);
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_GE(activeReserved, kBurstBytes);
+    BOOST_CHECK_LE(idleReserved, Buffer::kInitialSize);
+}
+
+BOOST_AUTO_TEST_CASE(testZeroCopyReleasesOwners) {
+    static const size_t kPayloadBytes = 1024 * 1024;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 11, true), "TestServer");
+    TcpClient client(&loop, InetAddress("127.0.0.1", kPort + 11), "TestClient");
+
+    server.setZeroCopyThreshold(64 * 1024);
+
+    std::weak_ptr<const string> weakPayload;
+    size_t received = 0;
+    size_t pinned = SIZE_MAX;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            // Neither reading nor writing once sent, only completions are left
+            conn->stopRead();
+
+            const auto payload = std::make_shared<const string>(kPayloadBytes, 'z');
+            weakPayload = payload;
+
+            conn->send(payload, *payload);
+        }
+    });
+
+    server.setMessageCallback(defaultMessageCallback);
+
+    client.setConnectionCallback(defaultConnectionCallback);
+    client.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        received += buf.readableBytes();
+        buf.retrieveAll();
+
+        if (received == kPayloadBytes) {
+            loop.runAfter(std::chrono::milliseconds(200), [&] {
+                server.getBufferStats([&](const TcpServer::BufferStats &stats) {
+                    pinned = stats.pinnedBytes;
+                    loop.quit();
+                });
+            });
+        }
+    });
+
+    server.start();
+    client.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_EQUAL(received, kPayloadBytes);
+    BOOST_CHECK_EQUAL(pinned, 0u);
+    BOOST_CHECK(weakPayload.expired());
+}
+
+// Connects @c nClients echo clients at once to a started echo @c server,
+// returns the server's buffer stats once every client got its echo.
+static TcpServer::BufferStats echoFromClients(EventLoop &loop, TcpServer &server, uint16_t port, int nClients) {
+    std::vector<std::unique_ptr<TcpClient>> clients;
+    int echoed = 0;
+    TcpServer::BufferStats stats;
+
+    for (int i = 0; i < nClients; i++) {
+        auto client = std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", port), "TestClient");
+
+        client->setConnectionCallback([](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->send("ping");
+            }
+        });
+
+        client->setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+            buf.retrieveAll();
+
+            if (++echoed == nClients) {
+                server.getBufferStats([&](const TcpServer::BufferStats &result) {
+                    stats = result;
+                    loop.quit();
+                });
+            }
+        });
+
+        client->connect();
+        clients.push_back(std::move(client));
+    }
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_EQUAL(echoed, nClients);
+
+    for (auto &client : clients) {
+        client->disconnect();
+    }
+
+    return stats;
+}
+
+static void echo(const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+    conn->send(buf);
+}
+
+BOOST_AUTO_TEST_CASE(testReusePortPerLoop) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 2, true), "TestServer", 2, TcpServer::Option::REUSE_PORT_PER_LOOP);
+
+    std::atomic<int> acceptedInMainLoop = 0;
+    std::mutex mu;
+    std::set<uint64_t> ids;
+    std::vector<string> badNames;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (!conn->connected()) {
+            return;
+        }
+
+        if (conn->getLoop() == &loop) {
+            acceptedInMainLoop++;
+        }
+
+        const string expectedName = "TestServer-127.0.0.1:" + std::to_string(kPort + 2) + "#" + std::to_string(conn->id());
+
+        std::lock_guard lg{mu};
+
+        ids.insert(conn->id());
+
+        if (conn->name() != expectedName) {
+            badNames.push_back(conn->name());
+        }
+    });
+
+    server.setMessageCallback(echo);
+    server.start();
+
+    const TcpServer::BufferStats stats = echoFromClients(loop, server, kPort + 2, 8);
+
+    BOOST_CHECK_EQUAL(stats.connections, 8u);
+    BOOST_CHECK_EQUAL(acceptedInMainLoop.load(), 0);
+
+    // Both loops hand out ids, none twice
+    BOOST_CHECK_EQUAL(ids.size(), 8u);
+    BOOST_CHECK(badNames.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testAcceptBatches) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 3, true), "TestServer", 2);
+
+    // Ten connections queued in the backlog take three batches
+    server.setMaxAcceptsPerRead(4);
+    server.setMessageCallback(echo);
+    server.start();
+
+    const TcpServer::BufferStats stats = echoFromClients(loop, server, kPort + 3, 10);
+
+    BOOST_CHECK_EQUAL(stats.connections, 10u);
+    BOOST_CHECK_EQUAL(server.acceptBatches(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(testAdmissionRejectsAboveLimit) {
+    static const int kClients = 4;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 4, true), "TestServer");
+
+    TcpServer::AdmissionLimits limits;
+    limits.maxConnections = 2;
+    limits.rejectResponse = "busy\n";
+
+    server.setAdmissionLimits(limits);
+    server.setMessageCallback(echo);
+    server.start();
+
+    std::vector<std::unique_ptr<TcpClient>> clients;
+    int echoed = 0;
+    int rejected = 0;
+
+    const auto onDone = [&] {
+        if (echoed + rejected == kClients) {
+            loop.quit();
+        }
+    };
+
+    for (int i = 0; i < kClients; i++) {
+        auto client = std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort + 4), "TestClient");
+
+        client->setConnectionCallback([](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->send("ping");
+            }
+        });
+
+        client->setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+            if (buf.retrieveAllAsString() == "busy\n") {
+                rejected++;
+            } else {
+                echoed++;
+            }
+
+            onDone();
+        });
+
+        client->connect();
+        clients.push_back(std::move(client));
+    }
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_EQUAL(echoed, 2);
+    BOOST_CHECK_EQUAL(rejected, 2);
+    BOOST_CHECK_EQUAL(server.rejectedConnections(), 2u);
+
+    for (auto &client : clients) {
+        client->disconnect();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testAdmissionPausesAcceptWhenQueueing) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 5, true), "TestServer", 1);
+
+    TcpServer::AdmissionLimits limits;
+    limits.maxPendingFunctors = 2;
+
+    server.setAdmissionLimits(limits);
+    server.setMessageCallback(echo);
+
+    // The IO loop hangs in the first connection callback until released
+    std::atomic<EventLoop *> pIoLoop = nullptr;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    server.setConnectionCallback([&pIoLoop, released](const TcpConnectionPtr &conn) {
+        if (conn->connected() && !pIoLoop.exchange(conn->getLoop())) {
+            released.wait();
+        }
+    });
+
+    server.start();
+
+    std::vector<std::unique_ptr<TcpClient>> clients;
+
+    for (int i = 0; i < 3; i++) {
+        clients.push_back(std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort + 5), "TestClient"));
+
+        clients.back()->setConnectionCallback([](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->send("ping");
+            }
+        });
+    }
+
+    int echoed = 0;
+
+    for (auto &client : clients) {
+        // The next client connects once this one is served
+        client->setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+            buf.retrieveAll();
+
+            if (++echoed == 3) {
+                loop.quit();
+            } else if (echoed == 2) {
+                clients[2]->connect();
+            }
+        });
+    }
+
+    TimerId hangCheck = loop.runEvery(std::chrono::milliseconds(1), [&] {
+        if (!pIoLoop.load()) {
+            return;
+        }
+
+        loop.cancel(hangCheck);
+
+        // Queue up more than the limit, the second connection pauses accepting
+        for (int i = 0; i < 3; i++) {
+            pIoLoop.load()->queueInLoop([] {});
+        }
+
+        clients[1]->connect();
+
+        loop.runAfter(std::chrono::milliseconds(20), [&release] {
+            release.set_value();
+        });
+    });
+
+    clients[0]->connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    // The third connection was accepted after resuming
+    BOOST_CHECK_EQUAL(server.acceptPauses(), 1u);
+    BOOST_CHECK_EQUAL(echoed, 3);
+
+    for (auto &client : clients) {
+        client->disconnect();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testHandOverListeningSockets) {
+    EventLoop loop;
+
+    // Replies tell which server answered
+    const auto tagged = [](const string &tag) {
+        return [tag](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+            conn->send(tag + buf.retrieveAllAsString());
+        };
+    };
+
+    auto oldServer = std::make_unique<TcpServer>(&loop, InetAddress(kPort + 6, true), "OldServer", 1);
+    oldServer->setMessageCallback(tagged("old:"));
+    oldServer->start();
+
+    std::unique_ptr<TcpServer> newServer;
+
+    TcpClient oldClient(&loop, InetAddress("127.0.0.1", kPort + 6), "OldClient");
+    TcpClient newClient(&loop, InetAddress("127.0.0.1", kPort + 6), "NewClient");
+
+    TcpConnectionPtr oldConn;
+    std::vector<string> replies;
+    bool handedOver = false;
+    bool drained = false;
+
+    oldClient.setConnectionCallback([&oldConn](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            oldConn = conn;
+            conn->send("a");
+        }
+    });
+
+    oldClient.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        replies.push_back(buf.retrieveAllAsString());
+
+        if (replies.size() == 1) {
+            int sv[2];
+            BOOST_REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv), 0);
+
+            handedOver = oldServer->handOver(sv[0], [&] {
+                drained = true;
+                loop.quit();
+            });
+
+            newServer = std::make_unique<TcpServer>(&loop, socket_ops::receiveFds(sv[1]), "NewServer", 1);
+            newServer->setMessageCallback(tagged("new:"));
+            newServer->start();
+
+            socket_ops::close(sv[0]);
+            socket_ops::close(sv[1]);
+
+            newClient.connect();
+        } else {
+            // The old connection stays with the old server until it closes
+            oldClient.disconnect();
+        }
+    });
+
+    newClient.setConnectionCallback([](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send("b");
+        }
+    });
+
+    newClient.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+        replies.push_back(buf.retrieveAllAsString());
+        oldConn->send("c");
+    });
+
+    oldClient.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK(handedOver);
+    BOOST_CHECK(drained);
+    BOOST_CHECK(oldServer->draining());
+    BOOST_CHECK_EQUAL(newServer->connectionCount(), 1u);
+
+    const std::vector<string> expected = {"old:a", "new:b", "old:c"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(replies.begin(), replies.end(), expected.begin(), expected.end());
+
+    newClient.disconnect();
+}
+
+BOOST_AUTO_TEST_CASE(testDrainedCallbackDestroysServer) {
+    static const int kClients = 3;
+
+    EventLoop loop;
+    auto server = std::make_unique<TcpServer>(&loop, InetAddress(kPort + 13, true), "TestServer");
+
+    std::vector<std::unique_ptr<TcpClient>> clients;
+    int connected = 0;
+    int drained = 0;
+
+    const auto handOverAndDisconnect = [&] {
+        int sv[2];
+        BOOST_REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv), 0);
+
+        // Nobody takes the listening socket over, it goes with the pair
+        BOOST_CHECK(server->handOver(sv[0], [&] {
+            drained++;
+            server.reset();
+
+            // Checks queued by the other closed connections would run now
+            loop.runAfter(std::chrono::milliseconds(100), [&] {
+                loop.quit();
+            });
+        }));
+
+        socket_ops::close(sv[0]);
+        socket_ops::close(sv[1]);
+
+        // Closed together, each closed connection asks whether the server drained
+        for (auto &client : clients) {
+            client->disconnect();
+        }
+    };
+
+    server->setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        // Out of the acceptor's callback, which handOver() closes
+        if (conn->connected() && ++connected == kClients) {
+            loop.queueInLoop(handOverAndDisconnect);
+        }
+    });
+
+    server->setMessageCallback(defaultMessageCallback);
+    server->start();
+
+    for (int i = 0; i < kClients; i++) {
+        auto client = std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort + 13), "TestClient");
+
+        client->setConnectionCallback(defaultConnectionCallback);
+        client->setMessageCallback(defaultMessageCallback);
+        client->connect();
+
+        clients.push_back(std::move(client));
+    }
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK_EQUAL(drained, 1);
+    BOOST_CHECK(!server);
+}
+
+BOOST_AUTO_TEST_CASE(testReusePortCpuSteering) {
+    // Clients send their SYNs from CPU 0, where both listeners are pinned
+    cpu_set_t savedCpuSet;
+    CPU_ZERO(&savedCpuSet);
+    (void)sched_getaffinity(0, sizeof(savedCpuSet), &savedCpuSet);
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(0, &cpuSet);
+    BOOST_REQUIRE_EQUAL(sched_setaffinity(0, sizeof(cpuSet), &cpuSet), 0);
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 9, true), "TestServer", 2, TcpServer::Option::REUSE_PORT_PER_LOOP);
+    server.setThreadPlacement({{0}});
+    server.setReusePortCpuSteering(true);
+
+    std::mutex mu;
+    std::set<EventLoop *> acceptedIn;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            std::lock_guard lg{mu};
+            acceptedIn.insert(conn->getLoop());
+        }
+    });
+
+    server.setMessageCallback(echo);
+    server.start();
+
+    const TcpServer::BufferStats stats = echoFromClients(loop, server, kPort + 9, 8);
+
+    (void)sched_setaffinity(0, sizeof(savedCpuSet), &savedCpuSet);
+
+    BOOST_CHECK_EQUAL(stats.connections, 8u);
+
+    // The first listener matches CPU 0, the kernel hash would have used both
+    std::lock_guard lg{mu};
+    BOOST_CHECK_EQUAL(acceptedIn.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(testUnixDomainEcho) {
+    const string path = "/tmp/mini_muduo_test_" + std::to_string(::getpid()) + ".sock";
+
+    for (const InetAddress &serverAddr :
+         {InetAddress::unixDomain(path), InetAddress::unixDomain("mini_muduo_test", true)}) {
+        EventLoop loop;
+        TcpServer server(&loop, serverAddr, "UnixServer", 1);
+        TcpClient client(&loop, serverAddr, "UnixClient");
+
+        string serverLocal;
+        string clientPeer;
+        string received;
+
+        server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                serverLocal = conn->localAddress().toIpPort();
+            }
+        });
+
+        server.setMessageCallback(echo);
+        server.start();
+
+        client.setConnectionCallback([&clientPeer](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                clientPeer = conn->peerAddress().toIpPort();
+                conn->send("ping");
+            }
+        });
+
+        client.setMessageCallback([&](const TcpConnectionPtr &, Buffer &buf, Timestamp) {
+            received += buf.retrieveAllAsString();
+
+            if (received.size() >= 4) {
+                loop.quit();
+            }
+        });
+
+        client.connect();
+
+        loop.runAfter(std::chrono::seconds(10), [&] {
+            loop.quit();
+        });
+
+        loop.loop();
+
+        BOOST_CHECK_EQUAL(received, "ping");
+        BOOST_CHECK_EQUAL(serverLocal, serverAddr.toIpPort());
+        BOOST_CHECK_EQUAL(clientPeer, serverAddr.toIpPort());
+        BOOST_CHECK_EQUAL(serverAddr.port(), 0);
+
+        client.disconnect();
+    }
+
+    BOOST_CHECK_EQUAL(InetAddress::unixDomain("name", true).toIpPort(), "@name");
+
+    ::unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testMigrateConnection) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 7, true), "TestServer", 2);
+
+    std::mutex mu;
+    std::vector<EventLoop *> acceptedIn;  // per connection, round robin
+    std::vector<EventLoop *> echoedIn;    // per message of the echo client
+    EventLoop *pClosedIn = nullptr;
+    bool wrongThread = false;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        std::lock_guard lg{mu};
+
+        wrongThread |= !conn->getLoop()->isInLoopThread();
+
+        if (conn->connected()) {
+            acceptedIn.push_back(conn->getLoop());
+        } else if (!echoedIn.empty() && !pClosedIn) {
+            pClosedIn = conn->getLoop();
+        }
+    });
+
+    server.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        {
+            std::lock_guard lg{mu};
+
+            wrongThread |= !conn->getLoop()->isInLoopThread();
+            echoedIn.push_back(conn->getLoop());
+
+            // Over to the loop of the idle client
+            if (echoedIn.size() == 1) {
+                conn->migrateTo(acceptedIn[0]);
+            }
+        }
+
+        conn->send(buf);
+    });
+
+    server.start();
+
+    TcpClient idleClient(&loop, InetAddress("127.0.0.1", kPort + 7), "IdleClient");
+    TcpClient echoClient(&loop, InetAddress("127.0.0.1", kPort + 7), "EchoClient");
+
+    string sent;
+    string received;
+
+    idleClient.setConnectionCallback([&echoClient](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            echoClient.connect();
+        }
+    });
+
+    idleClient.setMessageCallback(defaultMessageCallback);
+
+    echoClient.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            sent += "0";
+            conn->send("0");
+        } else {
+            loop.quit();
+        }
+    });
+
+    echoClient.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        received += buf.retrieveAllAsString();
+
+        if (received.size() < 20) {
+            const string next = std::to_string(received.size() % 10);
+
+            sent += next;
+            conn->send(next);
+        } else if (received.size() == sent.size()) {
+            echoClient.disconnect();
+        }
+    });
+
+    idleClient.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    std::lock_guard lg{mu};
+
+    BOOST_REQUIRE_EQUAL(acceptedIn.size(), 2u);
+    BOOST_CHECK_NE(acceptedIn[0], acceptedIn[1]);
+
+    BOOST_CHECK_EQUAL(received, sent);
+    BOOST_REQUIRE_EQUAL(echoedIn.size(), 20u);
+    BOOST_CHECK_EQUAL(echoedIn[0], acceptedIn[1]);
+    BOOST_CHECK(std::all_of(echoedIn.begin() + 1, echoedIn.end(), [&](EventLoop *pLoop) {
+        return pLoop == acceptedIn[0];
+    }));
+
+    BOOST_CHECK_EQUAL(pClosedIn, acceptedIn[0]);
+    BOOST_CHECK(!wrongThread);
+    BOOST_CHECK_EQUAL(server.migratedConnections(), 1u);
+
+    idleClient.disconnect();
+}
+
+BOOST_AUTO_TEST_CASE(testConnectionOwnsItself) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 15, true), "TestServer", 2);
+
+    std::mutex mu;
+    std::vector<EventLoop *> acceptedIn;
+    std::weak_ptr<TcpConnection> weakConn;  // of the echo client, nothing else holds it outside the server
+    bool disconnected = false;
+    bool aliveAfterDisconnect = false;
+
+    server.setConnectionCallback([&](const TcpConnectionPtr &conn) {
+        std::lock_guard lg{mu};
+
+        if (conn->connected()) {
+            acceptedIn.push_back(conn->getLoop());
+
+            if (acceptedIn.size() == 2) {
+                weakConn = conn;
+            }
+        } else if (conn == weakConn.lock()) {
+            disconnected = true;
+
+            // The server queues onConnectionDestroyed() after this callback, the inner
+            // closure runs after it, when self_ is all that is left
+            EventLoop *pLoop = conn->getLoop();
+
+            pLoop->queueInLoop([&, pLoop] {
+                pLoop->queueInLoop([&] {
+                    std::lock_guard lg2{mu};
+                    aliveAfterDisconnect = !weakConn.expired();
+                });
+            });
+        }
+    });
+
+    server.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        {
+            std::lock_guard lg{mu};
+
+            if (conn->getLoop() != acceptedIn[0]) {
+                conn->migrateTo(acceptedIn[0]);
+            }
+        }
+
+        conn->send(buf);
+    });
+
+    server.start();
+
+    TcpClient idleClient(&loop, InetAddress("127.0.0.1", kPort + 15), "IdleClient");
+    TcpClient echoClient(&loop, InetAddress("127.0.0.1", kPort + 15), "EchoClient");
+
+    string received;
+
+    idleClient.setConnectionCallback([&echoClient](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            echoClient.connect();
+        }
+    });
+
+    idleClient.setMessageCallback(defaultMessageCallback);
+
+    echoClient.setConnectionCallback([](const TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->send("0");
+        }
+    });
+
+    echoClient.setMessageCallback([&](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        received += buf.retrieveAllAsString();
+
+        if (received.size() < 10) {
+            conn->send(std::to_string(received.size()));
+        } else {
+            echoClient.disconnect();
+        }
+    });
+
+    // Until the server lets go of the connection
+    loop.runEvery(std::chrono::milliseconds(10), [&] {
+        std::lock_guard lg{mu};
+
+        if (disconnected && weakConn.expired()) {
+            loop.quit();
+        }
+    });
+
+    idleClient.connect();
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    std::lock_guard lg{mu};
+
+    BOOST_CHECK_EQUAL(received, "0123456789");
+    BOOST_CHECK_EQUAL(server.migratedConnections(), 1u);
+    BOOST_CHECK(disconnected);
+    BOOST_CHECK(aliveAfterDisconnect);
+    BOOST_CHECK(weakConn.expired());
+
+    idleClient.disconnect();
+}
+
+BOOST_AUTO_TEST_CASE(testRebalanceSpreadsBusyConnections) {
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(kPort + 8, true), "TestServer", 2);
+
+    // All peers are 127.0.0.1, all land in one loop
+    server.setLoopSelection(EventLoopThreadPool::SelectionPolicy::PEER_ADDRESS_HASH);
+    server.setRebalancing(std::chrono::milliseconds(20), 0.1);
+
+    // Every message keeps its loop busy for a while
+    server.setMessageCallback([](const TcpConnectionPtr &conn, Buffer &buf, Timestamp) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+
+        while (std::chrono::steady_clock::now() < until) {
+        }
+
+        conn->send(buf);
+    });
+
+    server.start();
+
+    std::vector<std::unique_ptr<TcpClient>> clients;
+
+    for (int i = 0; i < 3; i++) {
+        auto client = std::make_unique<TcpClient>(&loop, InetAddress("127.0.0.1", kPort + 8), "TestClient");
+
+        client->setConnectionCallback([](const TcpConnectionPtr &conn) {
+            if (conn->connected()) {
+                conn->send("ping");
+            }
+        });
+
+        client->setMessageCallback(echo);
+        client->connect();
+        clients.push_back(std::move(client));
+    }
+
+    bool spread = false;
+
+    loop.runEvery(std::chrono::milliseconds(50), [&] {
+        server.getTrafficStats([&](const std::vector<TcpServer::LoopTrafficStats> &stats) {
+            spread = std::all_of(stats.begin(), stats.end(), [](const TcpServer::LoopTrafficStats &loopStats) {
+                return loopStats.connections > 0;
+            });
+
+            if (spread) {
+                loop.quit();
+            }
+        });
+    });
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_CHECK(spread);
+    BOOST_CHECK_GE(server.migratedConnections(), 1u);
+    BOOST_CHECK_EQUAL(server.connectionCount(), 3u);
+
+    for (auto &client : clients) {
+        client->disconnect();
+    }
+}
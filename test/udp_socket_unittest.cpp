@@ -0,0 +1,124 @@
+#include <mini_muduo/udp_socket.h>
+
+#include <string>
+#include <vector>
+
+#include <mini_muduo/event_loop.h>
+#include <mini_muduo/inet_address.h>
+#include <mini_muduo/udp_server.h>
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace mini_muduo;
+using std::string;
+
+static const uint16_t kPort = 20360;
+
+static void echo(UdpSocket &socket, const InetAddress &peerAddr, std::string_view data, Timestamp) {
+    socket.send(peerAddr, data);
+}
+
+BOOST_AUTO_TEST_CASE(testEchoBatches) {
+    EventLoop loop;
+
+    UdpServer server(&loop, InetAddress(kPort, true), "UdpServer", 2);
+    server.setMessageCallback(echo);
+    server.start();
+
+    BOOST_CHECK_EQUAL(server.sockets().size(), 2u);
+
+    UdpSocket client(&loop, InetAddress(0, true), "UdpClient");
+
+    const int kDatagrams = 200;
+    std::vector<string> received;
+
+    client.setMessageCallback([&](UdpSocket &, const InetAddress &peerAddr, std::string_view data, Timestamp) {
+        BOOST_CHECK_EQUAL(peerAddr.port(), kPort);
+
+        received.emplace_back(data);
+
+        if (received.size() == kDatagrams) {
+            loop.quit();
+        }
+    });
+    client.start();
+
+    // Queued in one iteration, they leave in a few sendmmsg() calls
+    loop.runAfter(std::chrono::milliseconds(1), [&] {
+        for (int i = 0; i < kDatagrams; i++) {
+            client.send(InetAddress("127.0.0.1", kPort), "datagram " + std::to_string(i));
+        }
+    });
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_REQUIRE_EQUAL(received.size(), static_cast<size_t>(kDatagrams));
+    BOOST_CHECK_EQUAL(received.front(), "datagram 0");
+    BOOST_CHECK_EQUAL(received.back(), "datagram " + std::to_string(kDatagrams - 1));
+
+    BOOST_CHECK_EQUAL(client.stats().datagramsSent, static_cast<uint64_t>(kDatagrams));
+    BOOST_CHECK_LT(client.stats().sendCalls, static_cast<uint64_t>(kDatagrams));
+}
+
+BOOST_AUTO_TEST_CASE(testSegmentationKeepsDatagrams) {
+    EventLoop loop;
+
+    UdpSocket::Options options;
+    options.gso = true;
+    options.gro = true;
+
+    UdpSocket receiver(&loop, InetAddress(kPort + 1, true), "Receiver", options);
+    UdpSocket sender(&loop, InetAddress(0, true), "Sender", options);
+
+    std::vector<string> received;
+
+    receiver.setMessageCallback([&](UdpSocket &, const InetAddress &, std::string_view data, Timestamp) {
+        received.emplace_back(data);
+
+        if (received.size() == 9) {
+            loop.quit();
+        }
+    });
+    receiver.start();
+
+    // One GSO message of 8 datagrams, the last one shorter, then one on its own
+    const string full(1000, 'f');
+    const string last(300, 'l');
+    const string alone(1200, 'a');
+
+    loop.runAfter(std::chrono::milliseconds(1), [&] {
+        for (int i = 0; i < 7; i++) {
+            sender.send(receiver.localAddress(), full);
+        }
+
+        sender.send(receiver.localAddress(), last);
+        sender.send(receiver.localAddress(), alone);
+    });
+
+    loop.runAfter(std::chrono::seconds(10), [&] {
+        loop.quit();
+    });
+
+    loop.loop();
+
+    BOOST_REQUIRE_EQUAL(received.size(), 9u);
+
+    for (int i = 0; i < 7; i++) {
+        BOOST_CHECK_EQUAL(received[i], full);
+    }
+
+    BOOST_CHECK_EQUAL(received[7], last);
+    BOOST_CHECK_EQUAL(received[8], alone);
+
+    BOOST_CHECK_EQUAL(sender.stats().datagramsSent, 9u);
+
+    if (sender.gsoEnabled()) {
+        BOOST_CHECK_EQUAL(sender.stats().sendCalls, 1u);
+    }
+}